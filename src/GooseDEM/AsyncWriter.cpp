@@ -0,0 +1,207 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_ASYNCWRITER_CPP
+#define GOOSEDEM_ASYNCWRITER_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "AsyncWriter.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// ------------------------------------------ constructor ------------------------------------------
+
+inline AsyncWriter::AsyncWriter(size_t capacity) :
+  m_capacity(capacity), m_pending(0), m_stop(false)
+{
+  // check input
+  assert( m_capacity > 0 );
+
+  // preallocate the staging buffers (their size is set by the first snapshots)
+  m_free.resize(m_capacity);
+
+  // start the background thread
+  m_thread = std::thread(&AsyncWriter::run, this);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline AsyncWriter::~AsyncWriter()
+{
+  // stop the background thread, after it has written all staged snapshots
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+
+  m_cv_write.notify_one();
+
+  m_thread.join();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void AsyncWriter::push(const Eigen::Ref<const MatD> &data,
+  std::function<void(const MatD &)> write)
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  // backpressure: wait for a free buffer
+  m_cv_push.wait(lock, [this]{ return m_pending < m_capacity || m_error; });
+
+  rethrow();
+
+  // take a staging buffer
+  Task task;
+
+  task.data  = std::move(m_free.back());
+  task.write = std::move(write);
+
+  m_free.pop_back();
+
+  // count the snapshot before releasing the lock: another "push" waits for the buffer, and "flush"
+  // waits until the snapshot is copied and written
+  m_pending += 1;
+
+  // copy to the staging buffer (that does not reallocate if the shape is unchanged), without
+  // holding the lock
+  lock.unlock();
+
+  try
+  {
+    task.data = data;
+  }
+  catch (...)
+  {
+    // release the buffer
+    lock.lock();
+    m_free.push_back(std::move(task.data));
+    m_pending -= 1;
+    lock.unlock();
+    m_cv_push.notify_all();
+    throw;
+  }
+
+  lock.lock();
+
+  // stage
+  m_queue.push_back(std::move(task));
+
+  lock.unlock();
+
+  m_cv_write.notify_one();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void AsyncWriter::dump(const std::string &fname, const ColD &matrix)
+{
+  push(Eigen::Map<const MatD>(matrix.data(), matrix.size(), 1),
+    [fname](const MatD &data){ GooseDEM::dump(fname, data); });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void AsyncWriter::dump(const std::string &fname, const MatD &matrix)
+{
+  push(matrix, [fname](const MatD &data){ GooseDEM::dump(fname, data); });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void AsyncWriter::write(TrajectoryWriter &trajectory, const ColD &matrix)
+{
+  push(Eigen::Map<const MatD>(matrix.data(), matrix.size(), 1),
+    [&trajectory](const MatD &data){ trajectory.write(data); });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void AsyncWriter::write(TrajectoryWriter &trajectory, const MatD &matrix)
+{
+  push(matrix, [&trajectory](const MatD &data){ trajectory.write(data); });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void AsyncWriter::flush()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  m_cv_push.wait(lock, [this]{ return m_pending == 0 || m_error; });
+
+  rethrow();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t AsyncWriter::size()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  return m_pending;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void AsyncWriter::rethrow()
+{
+  if ( ! m_error ) return;
+
+  std::exception_ptr error = m_error;
+
+  m_error = nullptr;
+
+  std::rethrow_exception(error);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void AsyncWriter::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+
+  while ( true )
+  {
+    // wait for a staged snapshot, stop once all snapshots are written
+    m_cv_write.wait(lock, [this]{ return ! m_queue.empty() || m_stop; });
+
+    if ( m_queue.empty() ) return;
+
+    Task task = std::move(m_queue.front());
+
+    m_queue.pop_front();
+
+    // write, without holding the lock
+    lock.unlock();
+
+    std::exception_ptr error;
+
+    try { task.write(task.data); } catch (...) { error = std::current_exception(); }
+
+    lock.lock();
+
+    // release the buffer
+    m_free.push_back(std::move(task.data));
+
+    m_pending -= 1;
+
+    if ( error ) m_error = error;
+
+    m_cv_push.notify_all();
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,100 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_ASYNCWRITER_H
+#define GOOSEDEM_ASYNCWRITER_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include "GooseDEM.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+// Asynchronous output: a snapshot is copied to a (preallocated, reused) staging buffer, after which
+// the simulation continues while a background thread writes the snapshot. The snapshots are written
+// in the order in which they are pushed. At most "capacity" snapshots are staged or being written:
+// beyond that a push waits until a buffer is released (backpressure). The default "capacity=2"
+// corresponds to double buffering: one snapshot is written while the next is staged.
+// An exception thrown while writing is re-thrown by the next "push" or "flush". The destructor
+// writes all pending snapshots. Several threads can push concurrently (each snapshot is counted as
+// soon as it takes a buffer); the snapshots of different threads are then written in the order in
+// which they are staged.
+
+class AsyncWriter
+{
+private:
+
+  // staged snapshot: data, and the operation that writes it
+  struct Task
+  {
+    MatD data;
+    std::function<void(const MatD &)> write;
+  };
+
+  // staging buffers
+  std::vector<MatD> m_free;     // buffers that are not in use
+  std::deque<Task>  m_queue;    // staged snapshots, in order
+  size_t            m_capacity; // maximum number of staged snapshots (including the one written)
+  size_t            m_pending;  // number of staged snapshots (including the one written)
+
+  // thread
+  std::thread             m_thread;
+  std::mutex              m_mutex;
+  std::condition_variable m_cv_push;  // a buffer is released
+  std::condition_variable m_cv_write; // a snapshot is staged (or the writer is stopped)
+  bool                    m_stop;
+  std::exception_ptr      m_error;
+
+public:
+
+  // constructor: start the background thread
+  AsyncWriter(size_t capacity=2);
+
+  // the writer cannot be copied
+  AsyncWriter(const AsyncWriter &) = delete;
+  AsyncWriter& operator=(const AsyncWriter &) = delete;
+
+  // destructor: write all pending snapshots, stop the background thread
+  ~AsyncWriter();
+
+  // stage a snapshot, that is written by calling "write(data)" from the background thread
+  void push(const Eigen::Ref<const MatD> &data, std::function<void(const MatD &)> write);
+
+  // stage a snapshot for "GooseDEM::dump"
+  void dump(const std::string &fname, const ColD &matrix);
+  void dump(const std::string &fname, const MatD &matrix);
+
+  // stage a frame for a trajectory (that must not be written to directly until "flush")
+  void write(TrajectoryWriter &trajectory, const ColD &matrix);
+  void write(TrajectoryWriter &trajectory, const MatD &matrix);
+
+  // wait until all staged snapshots are written
+  void flush();
+
+  // return the number of staged snapshots (including the one that is being written)
+  size_t size();
+
+private:
+
+  // background thread: write the staged snapshots
+  void run();
+
+  // re-throw an exception from the background thread (the mutex must be locked)
+  void rethrow();
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -17,23 +17,70 @@ namespace GooseDEM {
 
 // -------------------------------------------------------------------------------------------------
 
-inline Dashpot::Dashpot(const MatS &particles, const ColD &eta) :
-  m_particles(particles), m_eta(eta)
+inline Dashpot::Dashpot() : Dashpot(std::make_shared<const Topology>(), ColD())
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Dashpot::Dashpot(MatS particles, ColD eta) :
+  Dashpot(std::make_shared<const Topology>(std::move(particles)), std::move(eta))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Dashpot::Dashpot(std::shared_ptr<const Topology> topology, ColD eta) :
+  Dashpot(PairState(std::move(topology)), std::move(eta))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Dashpot::Dashpot(MatS particles, ColT type, ColD eta) :
+  Dashpot(std::make_shared<const Topology>(std::move(particles)), std::move(type), std::move(eta))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Dashpot::Dashpot(std::shared_ptr<const Topology> topology, ColT type, ColD eta) :
+  Dashpot(PairState(std::move(topology), std::move(type)), std::move(eta))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Dashpot::Dashpot(PairState state, ColD eta) :
+  m_state(std::move(state)), m_eta(std::move(eta))
 {
   // check input
-  assert( m_particles.rows() == m_eta.size() );
+  assert( m_state.check(m_eta.size()) );
 }
 
 // -------------------------------------------------------------------------------------------------
 
 inline MatD Dashpot::force(const MatD &V) const
 {
-  // dimensions
-  auto n    = V.rows(); // number of particles
-  auto ndim = V.cols(); // number of dimensions
-
   // zero-initialize force per particle
-  MatD F = MatD::Zero(n, ndim);
+  MatD F = MatD::Zero(V.rows(), V.cols());
+
+  // all dashpots
+  add_force(V, m_state.size(), [](size_t k){ return k; }, F);
+
+  return F;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <class P>
+inline void Dashpot::add_force(const MatD &V, size_t m, P pair, MatD &F) const
+{
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // number of dimensions
+  auto ndim = V.cols();
 
   // local variables
   cppmat::cartesian::vector<double> vi(ndim); // velocity of particle "i"
@@ -41,19 +88,22 @@ inline MatD Dashpot::force(const MatD &V) const
   cppmat::cartesian::vector<double> dv(ndim); // velocity difference
   cppmat::cartesian::vector<double> f (ndim); // force vector
 
-  // loop over all dashpots
-  for ( auto p = 0 ; p < m_particles.rows() ; ++p )
+  // loop over the dashpots
+  for ( size_t k = 0 ; k < m ; ++k )
   {
+    // - pair number, skip broken pairs
+    auto p = pair(k);
+    if ( ! m_state.active(p) ) continue;
     // - extract particle numbers
-    auto i = m_particles(p,0);
-    auto j = m_particles(p,1);
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
     // - copy the particles' velocities to the vectors "vi" and "vj"
     std::copy(V.data()+i*ndim, V.data()+(i+1)*ndim, vi.data());
     std::copy(V.data()+j*ndim, V.data()+(j+1)*ndim, vj.data());
     // - compute the velocity difference vector
     dv = vj - vi;
     // - compute the force vector
-    f = m_eta(p) * dv;
+    f = m_eta(m_state.param(p)) * dv;
     // - assemble the force to the particles
     for ( auto d = 0 ; d < ndim ; ++d )
     {
@@ -61,33 +111,243 @@ inline MatD Dashpot::force(const MatD &V) const
       F(j,d) -= f(d);
     }
   }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Dashpot::force(const MatD &X, const MatD &V, const Periodic &box) const
+{
+  // non-periodic: the positions are not needed
+  if ( not box.periodic() ) return force(V);
+
+  // check input
+  assert( X.rows() == V.rows() );
+  assert( X.cols() == V.cols() );
+
+  // zero-initialize force per particle
+  MatD F = MatD::Zero(V.rows(), V.cols());
+
+  // all dashpots
+  add_force(X, V, box, m_state.size(), [](size_t k){ return k; }, F);
 
   return F;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline ColS Dashpot::coordination(const MatD &X) const
+inline void Dashpot::force(const MatD &X, const MatD &V, const Periodic &box, const Index *index,
+  size_t m, MatD &F) const
 {
-  // zero-initialize coordination per particle
-  ColS C = ColS::Zero(X.rows());
+  // check input
+  assert( X.rows() == V.rows() );
+  assert( X.cols() == V.cols() );
+  assert( F.rows() == V.rows() );
+  assert( F.cols() == V.cols() );
+
+  // non-periodic: the positions are not needed
+  if ( not box.periodic() ) return add_force(V, m, [index](size_t k){ return index[k]; }, F);
+
+  add_force(X, V, box, m, [index](size_t k){ return index[k]; }, F);
+}
 
-  // loop over all springs
-  for ( auto p = 0 ; p < m_particles.rows() ; ++p )
+// -------------------------------------------------------------------------------------------------
+
+template <class P>
+inline void Dashpot::add_force(const MatD &X, const MatD &V, const Periodic &box, size_t m, P pair,
+  MatD &F) const
+{
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // number of dimensions
+  auto ndim = V.cols();
+
+  // local variables
+  cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
+  cppmat::cartesian::vector<double> xj(ndim); // position of particle "j"
+  cppmat::cartesian::vector<double> dx(ndim); // position difference
+  cppmat::cartesian::vector<double> vi(ndim); // velocity of particle "i"
+  cppmat::cartesian::vector<double> vj(ndim); // velocity of particle "j"
+  cppmat::cartesian::vector<double> dv(ndim); // velocity difference
+  cppmat::cartesian::vector<double> f (ndim); // force vector
+
+  // loop over the dashpots
+  for ( size_t k = 0 ; k < m ; ++k )
   {
+    // - pair number, skip broken pairs
+    auto p = pair(k);
+    if ( ! m_state.active(p) ) continue;
     // - extract particle numbers
-    auto i = m_particles(p,0);
-    auto j = m_particles(p,1);
-    // - add to coordination
-    C(i) += 1;
-    C(j) += 1;
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
+    // - copy the particles' positions and velocities
+    std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
+    std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
+    std::copy(V.data()+i*ndim, V.data()+(i+1)*ndim, vi.data());
+    std::copy(V.data()+j*ndim, V.data()+(j+1)*ndim, vj.data());
+    // - compute the position and velocity difference vectors
+    dx = xj - xi;
+    dv = vj - vi;
+    // - apply periodicity: use the velocity of the nearest image
+    box.minimumImage(dx.data(), dv.data());
+    // - compute the force vector
+    f = m_eta(m_state.param(p)) * dv;
+    // - assemble the force to the particles
+    for ( auto d = 0 ; d < ndim ; ++d )
+    {
+      F(i,d) += f(d);
+      F(j,d) -= f(d);
+    }
   }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Dashpot::coordination(const MatD &X) const
+{
+  return m_state.coordination(X.rows());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Dashpot::tangent(const MatD &V) const
+{
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // dimensions
+  auto ndim = V.cols(); // number of dimensions
+
+  // zero-initialize tangent per dashpot
+  MatD C = MatD::Zero(pairs.rows(), ndim*ndim);
+
+  // loop over all dashpots: "eta * I"
+  for ( auto p = 0 ; p < pairs.rows() ; ++p )
+    if ( m_state.active(p) )
+      for ( auto a = 0 ; a < ndim ; ++a )
+        C(p,a*ndim+a) = m_eta(m_state.param(p));
 
   return C;
 }
 
 // -------------------------------------------------------------------------------------------------
 
+inline void Dashpot::deactivate(const ColS &index)
+{
+  m_state.deactivate(index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColB& Dashpot::active() const
+{
+  return m_state.active();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Dashpot::ndead() const
+{
+  return m_state.ndead();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Dashpot::compact()
+{
+  // nothing to do
+  if ( m_state.ndead() == 0 ) return m_state.compact();
+
+  // remove the broken pairs, keep the parameters of the remaining pairs
+  ColS index = m_state.compact();
+
+  compact_param(index);
+
+  return index;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Dashpot::compact(std::shared_ptr<const Topology> topology, const ColS &index)
+{
+  m_state.compact(std::move(topology), index);
+
+  compact_param(index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::shared_ptr<const Topology> Dashpot::topology() const
+{
+  return m_state.topology();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const MatS& Dashpot::particles() const
+{
+  return m_state.particles();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Dashpot::eta() const
+{
+  return m_state.expand(m_eta);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColT Dashpot::type() const
+{
+  return m_state.type();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Dashpot::ntype() const
+{
+  if ( ! m_state.typed() ) return 0;
+
+  return m_eta.size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Dashpot::append(const MatS &particles, const ColD &eta)
+{
+  // check input
+  assert( ! m_state.typed() );
+  assert( eta.size() == particles.rows() );
+
+  // pairs, parameters
+  m_state.append(particles);
+
+  PairState::join(m_eta, eta);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Dashpot::append(const MatS &particles, const ColT &type)
+{
+  // check input
+  assert( m_state.typed() );
+  assert( type.size() == particles.rows() );
+  assert( type.size() == 0 || type.maxCoeff() < m_eta.size() );
+
+  // pairs (the table is kept)
+  m_state.append(particles, type);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Dashpot::compact_param(const ColS &index)
+{
+  m_state.compact(m_eta, index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
 }
 
 // -------------------------------------------------------------------------------------------------
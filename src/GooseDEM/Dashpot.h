@@ -21,21 +21,84 @@ class Dashpot
 {
 private:
 
-  MatS m_particles; // particle pairs   [n, ndim]
-  ColD m_eta;       // damping constant [n]
+  PairState m_state; // topology (can be shared), type and active state of each pair
+  ColD m_eta;         // damping constant [n] or [ntype]
 
 public:
 
-  // constructor
-  Dashpot(){};
-  Dashpot(const MatS &particles, const ColD &eta);
+  // constructor (the topology can be shared between models)
+  Dashpot();
+  Dashpot(MatS particles, ColD eta);
+  Dashpot(std::shared_ptr<const Topology> topology, ColD eta);
+
+  // constructor with a parameter table: the parameters are given per type [ntype], each pair
+  // refers to a row of the table by its type [n]
+  Dashpot(MatS particles, ColT type, ColD eta);
+  Dashpot(std::shared_ptr<const Topology> topology, ColT type, ColD eta);
 
   // compute the force on each particle (the output could contain many zero rows)
+  // (in a periodic box the positions are needed to find the relative velocity of the images)
   MatD force(const MatD &v) const;
+  MatD force(const MatD &x, const MatD &v, const Periodic &box) const;
+
+  // add the force of the pairs "index" [m] to the force on each particle "F" [N, ndim]; pairs that
+  // do not share a particle (e.g. of one color, see "Topology::colored") can be added concurrently
+  void force(const MatD &x, const MatD &v, const Periodic &box, const Index *index, size_t m,
+    MatD &F) const;
 
   // compute the coordination of each particle
   ColS coordination(const MatD &X) const;
 
+  // compute the tangent of the force on the first particle w.r.t. the velocity difference, for
+  // each dashpot [n, ndim*ndim] (row-major blocks)
+  MatD tangent(const MatD &v) const;
+
+  // deactivate (break) pairs, by their index [m]
+  void deactivate(const ColS &index);
+
+  // return the active (1) or broken (0) state of each pair [n], and the number of broken pairs
+  const ColB& active() const;
+  size_t      ndead()  const;
+
+  // remove the broken pairs (in a new topology), return the former index of each remaining pair
+  ColS compact();
+
+  // replace the topology by one that contains the former pairs "index" (e.g. the topology that
+  // resulted from "compact" of another model that shared the topology)
+  void compact(std::shared_ptr<const Topology> topology, const ColS &index);
+
+  // append pairs [m, 2] (e.g. the interactions of inserted particles), with their parameters [m],
+  // or their type [m] if the parameters are stored per type; the topology is no longer shared with
+  // other models
+  void append(const MatS &particles, const ColD &eta);
+  void append(const MatS &particles, const ColT &type);
+
+  // return parameters (per pair [n], also if they are stored per type)
+  std::shared_ptr<const Topology> topology() const;
+  const MatS& particles() const;
+  ColD eta()       const;
+
+  // return the type of each pair [n] and the number of types (both empty if the parameters are
+  // stored per pair)
+  ColT   type()  const;
+  size_t ntype() const;
+
+private:
+
+  // constructor from the state of the pairs (per pair or per type)
+  Dashpot(PairState state, ColD eta);
+
+  // add the force of the pairs "pair(0), ..., pair(m-1)" to "F" [N, ndim] (the positions are only
+  // used in a periodic box)
+  template <class P>
+  void add_force(const MatD &v, size_t m, P pair, MatD &F) const;
+  template <class P>
+  void add_force(const MatD &x, const MatD &v, const Periodic &box, size_t m, P pair,
+    MatD &F) const;
+
+  // keep the parameters of the former pairs "index" (after compacting the pairs)
+  void compact_param(const ColS &index);
+
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -35,6 +35,14 @@
 #include "Geometry.h"
 #include "Geometry.cpp"
 
+#include "Loading.h"
+#include "Loading.cpp"
+
+#ifdef GOOSEDEM_USE_MPI
+#include "GeometryMPI.h"
+#include "GeometryMPI.cpp"
+#endif
+
 // -------------------------------------------------------------------------------------------------
 
 #endif
@@ -24,8 +24,8 @@ namespace Friction {
 
 // -------------------------------------------------------------------------------------------------
 
-inline Geometry::Geometry(const ColD &m, const MatD &x, const MatS &dofs) :
-  m_x(x), m_m(m), m_dofs(dofs)
+inline Geometry::Geometry(ColD m, MatD x, MatS dofs) :
+  m_x(std::move(x)), m_m(std::move(m)), m_dofs(std::move(dofs))
 {
   // extract dimensions
   m_N    = static_cast<size_t>(m_dofs.rows());
@@ -38,7 +38,7 @@ inline Geometry::Geometry(const ColD &m, const MatD &x, const MatS &dofs) :
   assert( m_m.size() == m_N    );
 
   // conversion vector
-  m_vec  = Vector(dofs);
+  m_vec  = Vector(m_dofs);
 
   // zero-initialize particle vectors
   m_v    = MatD::Zero(m_x.rows(), m_x.cols());
@@ -47,144 +47,1065 @@ inline Geometry::Geometry(const ColD &m, const MatD &x, const MatS &dofs) :
   // zero-initialize boundary conditions
   m_iip  = ColS();
   m_vp   = ColD();
+  m_np   = 0;
   m_fext = MatD::Zero(m_x.rows(), m_x.cols());
 
   // zero-initialize time
   m_t    = 0.0;
 
-  // compute (inverse of) DOF masses
-  m_M    = m_vec.asDofs(m_m);
-  m_Minv = m_M.cwiseInverse();
+  // zero-initialize coordination
+  m_coordination = ColS::Zero(m_N);
+
+  // no broken pairs
+  m_broken  = MatS::Zero(0, 2);
+  m_compact = 0.1;
+
+  // evaluate the constitutive models concurrently
+  m_nthread     = default_nthread();
+  m_nconcurrent = 10000;
+  m_grain       = 4096;
+
+  // compute (inverse of) DOF masses, without mass scaling
+  m_scaling    = MassScaling::none;
+  m_scaling_dt = 0.0;
+
+  update_M();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::set(const Spring &mat, size_t level)
+{
+  m_spring.clear();
+  m_level_spring.clear();
+
+  add(mat, level);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::add(const Spring &mat, size_t level)
+{
+  assert( level <= 1 );
+
+  m_spring.push_back(mat);
+  m_level_spring.push_back(level);
+
+  // update the coordination
+  update_coordination();
+
+  // reapply the mass scaling
+  if ( m_scaling != MassScaling::none ) update_M();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::set(const Dashpot &mat, size_t level)
+{
+  m_dashpot.clear();
+  m_level_dashpot.clear();
+
+  add(mat, level);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::add(const Dashpot &mat, size_t level)
+{
+  assert( level <= 1 );
+
+  m_dashpot.push_back(mat);
+  m_level_dashpot.push_back(level);
+
+  // update the coordination
+  update_coordination();
+
+  // reapply the mass scaling
+  if ( m_scaling != MassScaling::none ) update_M();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::set(const PotentialAdhesion &mat, size_t level)
+{
+  m_potentialadhesion.clear();
+  m_level_potentialadhesion.clear();
+
+  add(mat, level);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::add(const PotentialAdhesion &mat, size_t level)
+{
+  assert( level <= 1 );
+
+  m_potentialadhesion.push_back(mat);
+  m_level_potentialadhesion.push_back(level);
+
+  // update the coordination
+  update_coordination();
+
+  // reapply the mass scaling
+  if ( m_scaling != MassScaling::none ) update_M();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::append(const Spring &mat, size_t index)
+{
+  // check input
+  assert( index < m_spring.size() );
+  assert( mat.ndead() == 0 );
+
+  // append the pairs
+  Spring &dest = m_spring[index];
+
+  if ( dest.ntype() > 0 ) dest.append(mat.particles(), mat.type(), mat.eps_c());
+  else                    dest.append(mat.particles(), mat.k(), mat.D0(), mat.eps_c());
+
+  // update the coordination
+  m_coordination += mat.coordination(m_x);
+
+  // reapply the mass scaling
+  if ( m_scaling != MassScaling::none ) update_M();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::append(const Dashpot &mat, size_t index)
+{
+  // check input
+  assert( index < m_dashpot.size() );
+  assert( mat.ndead() == 0 );
+
+  // append the pairs
+  Dashpot &dest = m_dashpot[index];
+
+  if ( dest.ntype() > 0 ) dest.append(mat.particles(), mat.type());
+  else                    dest.append(mat.particles(), mat.eta());
+
+  // update the coordination
+  m_coordination += mat.coordination(m_x);
+
+  // reapply the mass scaling
+  if ( m_scaling != MassScaling::none ) update_M();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::append(const PotentialAdhesion &mat, size_t index)
+{
+  // check input
+  assert( index < m_potentialadhesion.size() );
+  assert( mat.ndead() == 0 );
+
+  // append the pairs
+  PotentialAdhesion &dest = m_potentialadhesion[index];
+
+  if ( dest.ntype() > 0 )
+    dest.append(mat.particles(), mat.type(), mat.D_c());
+  else
+    dest.append(mat.particles(), mat.k(), mat.b(), mat.r0(), mat.e(), mat.D_c());
+
+  // update the coordination
+  m_coordination += mat.coordination(m_x);
+
+  // reapply the mass scaling
+  if ( m_scaling != MassScaling::none ) update_M();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Geometry::nmodel() const
+{
+  return m_spring.size() + m_dashpot.size() + m_potentialadhesion.size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::set(const Wall &wall, size_t level)
+{
+  m_wall.clear();
+  m_level_wall.clear();
+
+  add(wall, level);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::add(const Wall &wall, size_t level)
+{
+  assert( level <= 1 );
+
+  m_wall.push_back(wall);
+  m_level_wall.push_back(level);
+
+  // reapply the mass scaling
+  if ( m_scaling != MassScaling::none ) update_M();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Geometry::nwall() const
+{
+  return m_wall.size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Geometry::wall_force(size_t i) const
+{
+  MatD f = m_wall[i].force(m_x, m_v, m_t);
+
+  for ( auto &n : m_vacant ) f.row(n).setZero();
+
+  return f;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Geometry::wall_reaction() const
+{
+  MatD R(m_wall.size(), m_ndim);
+
+  for ( size_t i = 0 ; i < m_wall.size() ; ++i )
+    R.row(i) = - wall_force(i).colwise().sum();
+
+  return R;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::set_nthread(size_t nthread, size_t nconcurrent)
+{
+  m_nthread     = std::max(nthread, static_cast<size_t>(1));
+  m_nconcurrent = nconcurrent;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::set_compaction(double fraction)
+{
+  m_compact = fraction;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::set(const Periodic &box)
+{
+  // check input
+  assert( not box.periodic() or static_cast<size_t>(box.H().rows()) == m_ndim );
+
+  m_box = box;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Periodic Geometry::box() const
+{
+  return m_box;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::fix_v(const ColS &iip, const ColD &vp)
+{
+  assert( iip.size() == vp.size() );
+
+  m_iip = iip;
+  m_vp  = vp;
+  m_np  = static_cast<size_t>(iip.size());
+
+  // keep the vacant slots fixed
+  update_iip();
+
+  // apply to the particle velocities
+  set_v(dofs_v());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::set_fext(const MatD &pvector)
+{
+  assert( pvector.rows() == m_x.rows() );
+  assert( pvector.cols() == m_x.cols() );
+
+  m_fext = pvector;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Geometry::fext() const
+{
+  return m_fext;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Geometry::fres() const
+{
+  // compute internal and external force
+  ColD Fint = m_vec.assembleDofs( f()    );
+  ColD Fext = m_vec.assembleDofs( m_fext );
+
+  // compute reaction forces, on the prescribed DOFs
+  for ( auto i = 0 ; i < m_iip.size() ; ++i ) Fext(m_iip(i)) = Fint(m_iip(i));
+
+  // return as particle vector
+  return m_vec.asParticle(Fext);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Geometry::solve()
+{
+  // compute internal and external force (the latter concurrently with the constitutive models, on
+  // a thread of the pool: serially, in the order of the deterministic mode)
+  ColD Fext(m_ndof);
+  ColD Fint = m_vec.assembleDofs( force(0, true, [&](){
+    m_vec.assembleDofs(m_fext, Fext, 0, m_ndof); }) );
+
+  // solve system of equations
+  ColD A = scale( Fint, Fext );
+
+  // enforce fixed displacement of boundary DOFs
+  for ( auto i = 0 ; i < m_iip.size() ; ++i ) A(m_iip(i)) = 0.0;
+
+  // return acceleration of DOFs
+  return A;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Geometry::scale(const ColD &Fint, const ColD &Fext) const
+{
+  ColD A(m_ndof);
+
+  parallel_range(m_ndof, m_grain, nthread(m_ndof), [&](size_t begin, size_t end)
+  {
+    A.segment(begin, end-begin) = m_Minv.segment(begin, end-begin).cwiseProduct(
+      Fint.segment(begin, end-begin) - Fext.segment(begin, end-begin) );
+  });
+
+  return A;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Geometry::solve_level(size_t level)
+{
+  // compute internal force
+  ColD Fint = m_vec.assembleDofs( f(level) );
+
+  // compute external force (applied at the fast level)
+  ColD Fext = ColD::Zero(m_ndof);
+
+  if ( level == 0 ) Fext = m_vec.assembleDofs( m_fext );
+
+  // solve system of equations
+  ColD A = scale( Fint, Fext );
+
+  // enforce fixed displacement of boundary DOFs
+  for ( auto i = 0 ; i < m_iip.size() ; ++i ) A(m_iip(i)) = 0.0;
+
+  // return acceleration of DOFs
+  return A;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::reset()
+{
+  m_stop.reset();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool Geometry::stop(double tol)
+{
+  // compute internal and external force
+  ColD Fint = m_vec.assembleDofs( f()    );
+  ColD Fext = m_vec.assembleDofs( m_fext );
+
+  // compute reaction forces, on the prescribed DOFs
+  for ( auto i = 0 ; i < m_iip.size() ; ++i ) Fext(m_iip(i)) = Fint(m_iip(i));
+
+  // compute residual force
+  ColD Res = Fint - Fext;
+
+  // sum of absolute
+  double res  = Res .cwiseAbs().sum();
+  double fext = Fext.cwiseAbs().sum();
+
+  // normalize
+  if ( fext != 0 ) res /= fext;
+
+  // check to stop
+  bool stop = m_stop.stop(res, tol);
+
+  // if stop: reset for next increment
+  if ( stop )
+  {
+    // - reset residuals to infinity
+    m_stop.reset();
+    // - ground system
+    m_v.setZero();
+    m_a.setZero();
+  }
+
+  return stop;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::timestep(double dt)
+{
+  // update time
+  m_t += dt;
+
+  // update periodic box (Lees-Edwards)
+  m_box.timestep(dt);
+
+  // break pairs
+  rupture();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::rupture()
+{
+  // broken pairs (in the order of the models)
+  std::vector<Index> broken;
+
+  // springs
+  for ( auto &spring : m_spring )
+  {
+    // - check the breaking criterion
+    ColS is = spring.rupture(m_x, m_box);
+
+    if ( is.size() == 0 ) continue;
+
+    // - list the broken pairs
+    const MatS &particles = spring.topology()->particles();
+
+    for ( auto k = 0 ; k < is.size() ; ++k )
+    {
+      broken.push_back(particles(is(k),0));
+      broken.push_back(particles(is(k),1));
+    }
+
+    // - dashpots that share the topology of the spring break with it
+    std::vector<size_t> shared;
+
+    for ( size_t d = 0 ; d < m_dashpot.size() ; ++d )
+      if ( m_dashpot[d].topology() == spring.topology() )
+        shared.push_back(d);
+
+    for ( auto &d : shared ) m_dashpot[d].deactivate(is);
+  }
+
+  // adhesion
+  for ( auto &adhesion : m_potentialadhesion )
+  {
+    // - check the breaking criterion
+    ColS ia = adhesion.rupture(m_x, m_box);
+
+    if ( ia.size() == 0 ) continue;
+
+    // - list the broken pairs
+    const MatS &particles = adhesion.topology()->particles();
+
+    for ( auto k = 0 ; k < ia.size() ; ++k )
+    {
+      broken.push_back(particles(ia(k),0));
+      broken.push_back(particles(ia(k),1));
+    }
+  }
+
+  // store the broken pairs
+  m_broken = Eigen::Map<const MatS>(broken.data(), broken.size()/2, 2);
+
+  // nothing broke: nothing to do
+  if ( m_broken.rows() == 0 ) return;
+
+  // remove the broken pairs if their fraction exceeds the threshold
+  compact_models(m_compact);
+
+  // update the coordination
+  update_coordination();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::compact_models(double fraction)
+{
+  // dashpots that have been compacted with a spring
+  std::vector<bool> done(m_dashpot.size(), false);
+
+  // springs, and the dashpots that share their topology
+  for ( auto &spring : m_spring )
+  {
+    std::vector<size_t> shared;
+
+    for ( size_t d = 0 ; d < m_dashpot.size() ; ++d )
+      if ( m_dashpot[d].topology() == spring.topology() && ! done[d] )
+        shared.push_back(d);
+
+    for ( auto &d : shared ) done[d] = true;
+
+    if ( spring.ndead() <= fraction * spring.topology()->size() ) continue;
+
+    ColS index = spring.compact();
+
+    for ( auto &d : shared ) m_dashpot[d].compact(spring.topology(), index);
+  }
+
+  // other dashpots
+  for ( size_t d = 0 ; d < m_dashpot.size() ; ++d )
+    if ( ! done[d] && m_dashpot[d].ndead() > fraction * m_dashpot[d].topology()->size() )
+      m_dashpot[d].compact();
+
+  // adhesion
+  for ( auto &adhesion : m_potentialadhesion )
+    if ( adhesion.ndead() > fraction * adhesion.topology()->size() )
+      adhesion.compact();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Geometry::insert(const MatD &x, const ColD &m, const MatD &v)
+{
+  // check input
+  assert( static_cast<size_t>(x.cols()) == m_ndim );
+  assert( x.rows() == m.size() );
+  assert( v.size() == 0 || ( v.rows() == x.rows() && v.cols() == x.cols() ) );
+  assert( m.size() == 0 || m.minCoeff() > 0.0 );
+
+  // number of particles to insert
+  size_t k = static_cast<size_t>(x.rows());
+
+  // double the capacity if there are not enough vacant slots
+  if ( k > m_vacant.size() ) grow(std::max(2 * m_N, m_N + k - m_vacant.size()));
+
+  // take the slots from the back
+  ColS index(k);
+
+  for ( size_t i = 0 ; i < k ; ++i )
+  {
+    // - slot
+    size_t n = m_vacant.back();
+    m_vacant.pop_back();
+    index(i) = n;
+    // - particle vectors
+    m_x   .row(n) = x.row(i);
+    m_a   .row(n).setZero();
+    m_fext.row(n).setZero();
+    m_m   (n)     = m(i);
+    if ( v.size() > 0 ) m_v.row(n) = v.row(i);
+    else                m_v.row(n).setZero();
+    // - DOF masses (the particle has its own DOFs)
+    for ( size_t d = 0 ; d < m_ndim ; ++d )
+    {
+      m_M   (m_dofs(n,d)) = m(i);
+      m_Minv(m_dofs(n,d)) = 1. / m(i);
+    }
+  }
+
+  // release the prescribed DOFs of the slots (those of the last vacant slots)
+  m_iip.conservativeResize(m_np + m_vacant.size() * m_ndim);
+  m_vp .conservativeResize(m_np + m_vacant.size() * m_ndim);
+
+  // reapply the mass scaling
+  if ( m_scaling != MassScaling::none ) update_M();
+
+  return index;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::remove(const ColS &particles)
+{
+  // check input
+  for ( auto i = 0 ; i < particles.size() ; ++i )
+  {
+    assert( static_cast<size_t>(particles(i)) < m_N );
+    assert( m_m(particles(i)) > 0.0 );
+    for ( size_t d = 0 ; d < m_ndim ; ++d )
+      assert( ( m_iip.head(m_np).array() != m_dofs(particles(i),d) ).all() );
+  }
+
+  // deactivate the pairs of the particles in all constitutive models, one by one such that the
+  // coordination is updated only for the pairs that were active
+  ColS pair(1);
+
+  auto deactivate = [&](auto &models)
+  {
+    for ( auto &mat : models )
+    {
+      const Topology &topology = *mat.topology();
+
+      for ( auto i = 0 ; i < particles.size() ; ++i )
+      {
+        if ( static_cast<size_t>(particles(i)) >= topology.N() ) continue;
+
+        ColS p = topology.pairs(particles(i));
+
+        for ( auto k = 0 ; k < p.size() ; ++k )
+        {
+          size_t ndead = mat.ndead();
+
+          pair(0) = p(k);
+
+          mat.deactivate(pair);
+
+          if ( mat.ndead() == ndead ) continue;
+
+          m_coordination(topology.particles()(p(k),0)) -= 1;
+          m_coordination(topology.particles()(p(k),1)) -= 1;
+        }
+      }
+    }
+  };
+
+  deactivate(m_spring);
+  deactivate(m_dashpot);
+  deactivate(m_potentialadhesion);
+
+  // remove the broken pairs if their fraction exceeds the threshold
+  compact_models(m_compact);
+
+  // vacate the slots, prescribe their DOFs at zero velocity
+  size_t np = static_cast<size_t>(m_iip.size());
+
+  m_iip.conservativeResize(np + particles.size() * m_ndim);
+  m_vp .conservativeResize(np + particles.size() * m_ndim);
+
+  for ( auto i = 0 ; i < particles.size() ; ++i )
+  {
+    size_t n = particles(i);
+
+    m_vacant.push_back(n);
+
+    m_v   .row(n).setZero();
+    m_a   .row(n).setZero();
+    m_fext.row(n).setZero();
+    m_m   (n) = 0.0;
+
+    for ( size_t d = 0 ; d < m_ndim ; ++d )
+    {
+      m_M   (m_dofs(n,d)) = 0.0;
+      m_Minv(m_dofs(n,d)) = 0.0;
+      m_iip (np + i*m_ndim + d) = m_dofs(n,d);
+      m_vp  (np + i*m_ndim + d) = 0.0;
+    }
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::reserve(size_t N)
+{
+  if ( N > m_N ) grow(N);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::grow(size_t N)
+{
+  // number of new slots
+  size_t k = N - m_N;
+
+  // particle vectors (the new slots are zero)
+  auto extend = [N](MatD &data)
+  {
+    size_t n = static_cast<size_t>(data.rows());
+    data.conservativeResize(N, data.cols());
+    data.bottomRows(N - n).setZero();
+  };
+
+  extend(m_x);
+  extend(m_v);
+  extend(m_a);
+  extend(m_fext);
+
+  m_m.conservativeResize(N);
+  m_m.tail(k).setZero();
+
+  m_coordination.conservativeResize(N);
+  m_coordination.tail(k).setZero();
+
+  // new DOFs for the new slots
+  m_dofs.conservativeResize(N, m_ndim);
+
+  for ( size_t n = m_N ; n < N ; ++n )
+    for ( size_t d = 0 ; d < m_ndim ; ++d )
+      m_dofs(n,d) = m_ndof + (n - m_N) * m_ndim + d;
+
+  m_M.conservativeResize(m_ndof + k * m_ndim);
+  m_M.tail(k * m_ndim).setZero();
+
+  // the new slots are vacant, used after the current vacant slots (the first new slot first)
+  std::vector<size_t> vacant;
+
+  for ( size_t n = N ; n > m_N ; --n ) vacant.push_back(n - 1);
+
+  vacant.insert(vacant.end(), m_vacant.begin(), m_vacant.end());
+
+  m_vacant = std::move(vacant);
+
+  // update the dimensions and the conversion
+  m_N    = N;
+  m_ndof = m_ndof + k * m_ndim;
+  m_vec  = Vector(m_dofs);
+
+  update_Minv();
+  update_iip();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Geometry::compact()
+{
+  // number of particles
+  size_t n = m_N - m_vacant.size();
+
+  // former number of each slot
+  ColS index = ColS::LinSpaced(m_N, 0, m_N - 1);
+
+  // vacant slots among the first "n", occupied slots after the first "n"
+  std::vector<bool> vacant(m_N, false);
+
+  for ( auto &i : m_vacant ) vacant[i] = true;
+
+  // swap-remove: move the last particle to the first vacant slot
+  size_t last = m_N;
+
+  for ( size_t i = 0 ; i < n ; ++i )
+  {
+    if ( ! vacant[i] ) continue;
+
+    do { --last; } while ( vacant[last] );
+
+    std::swap(index(i), index(last));
+  }
+
+  // nothing to do
+  if ( last == m_N ) return index;
+
+  // move the particles, with their DOFs
+  auto permute = [&index](auto &data)
+  {
+    auto copy = data;
+
+    for ( auto i = 0 ; i < index.size() ; ++i ) data.row(i) = copy.row(index(i));
+  };
+
+  permute(m_x);
+  permute(m_v);
+  permute(m_a);
+  permute(m_fext);
+  permute(m_dofs);
+  permute(m_m);
+  permute(m_coordination);
+
+  // vacant slots at the end, the first is used first
+  m_vacant.clear();
+
+  for ( size_t i = m_N ; i > n ; --i ) m_vacant.push_back(i - 1);
+
+  // conversion (the DOF values are unchanged, the DOFs moved with the particles)
+  m_vec = Vector(m_dofs);
+
+  update_iip();
+
+  // new number of each former particle
+  ColS renumber(m_N);
+
+  for ( size_t i = 0 ; i < m_N ; ++i ) renumber(index(i)) = i;
+
+  // remove all broken pairs, renumber the topologies (keeping them shared between models)
+  compact_models(0.0);
+
+  std::map<const Topology*, std::shared_ptr<const Topology>> topology;
+
+  auto update = [&](auto &models, auto &level)
+  {
+    for ( size_t m = 0 ; m < models.size() ; ++m )
+    {
+      auto &mat = models[m];
+
+      auto it = topology.find(mat.topology().get());
+
+      if ( it == topology.end() )
+      {
+        MatS particles = mat.topology()->particles();
+
+        for ( auto k = 0 ; k < particles.size() ; ++k )
+          particles.data()[k] = renumber(particles.data()[k]);
+
+        it = topology.emplace(mat.topology().get(),
+          std::make_shared<const Topology>(std::move(particles), m_N)).first;
+      }
+
+      auto ntop = it->second;
+
+      mat.compact(ntop, ColS::LinSpaced(ntop->size(), 0, ntop->size() - 1));
+    }
+
+    // remove the models without pairs
+    size_t k = 0;
+
+    for ( size_t m = 0 ; m < models.size() ; ++m )
+    {
+      if ( models[m].topology()->size() == 0 ) continue;
+
+      models[k] = models[m];
+      level [k] = level [m];
+      ++k;
+    }
+
+    models.resize(k);
+    level .resize(k);
+  };
+
+  update(m_spring           , m_level_spring           );
+  update(m_dashpot          , m_level_dashpot          );
+  update(m_potentialadhesion, m_level_potentialadhesion);
+
+  // update the coordination
+  update_coordination();
+
+  return index;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline void Geometry::set(const Spring &mat)
+inline ColS Geometry::vacant() const
 {
-  m_spring = mat;
+  ColS out(m_vacant.size());
+
+  for ( size_t i = 0 ; i < m_vacant.size() ; ++i ) out(i) = m_vacant[i];
+
+  return out;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline void Geometry::set(const Dashpot &mat)
+inline size_t Geometry::nvacant() const
 {
-  m_dashpot = mat;
+  return m_vacant.size();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline void Geometry::set(const PotentialAdhesion &mat)
+inline void Geometry::update_iip()
 {
-  m_potentialadhesion = mat;
+  m_iip.conservativeResize(m_np + m_vacant.size() * m_ndim);
+  m_vp .conservativeResize(m_np + m_vacant.size() * m_ndim);
+
+  for ( size_t i = 0 ; i < m_vacant.size() ; ++i )
+  {
+    for ( size_t d = 0 ; d < m_ndim ; ++d )
+    {
+      m_iip(m_np + i*m_ndim + d) = m_dofs(m_vacant[i],d);
+      m_vp (m_np + i*m_ndim + d) = 0.0;
+    }
+  }
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline void Geometry::fix_v(const ColS &iip, const ColD &vp)
+inline void Geometry::update_Minv()
 {
-  m_iip = iip;
-  m_vp  = vp;
+  m_Minv = ( m_M.array() > 0.0 ).select(m_M.array().inverse(), 0.0).matrix();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline void Geometry::set_fext(const MatD &pvector)
+inline MatS Geometry::broken() const
 {
-  assert( pvector.rows() == m_x.rows() );
-  assert( pvector.cols() == m_x.cols() );
+  return m_broken;
+}
 
-  m_fext = pvector;
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::dofs_KC(ColD &K, ColD &C) const
+{
+  // zero-initialize the stiffness and damping per particle
+  ColD k = ColD::Zero(m_N);
+  ColD c = ColD::Zero(m_N);
+
+  // sum the interactions of each particle: an interaction contributes to a particle through the
+  // diagonal and the off-diagonal block of the tangent (Gershgorin)
+  auto add = [](ColD &k, const MatS &particles, const ColD &kp)
+  {
+    for ( auto p = 0 ; p < particles.rows() ; ++p )
+    {
+      k(particles(p,0)) += 2. * kp(p);
+      k(particles(p,1)) += 2. * kp(p);
+    }
+  };
+
+  for ( auto &mat : m_spring            ) add(k, mat.particles(), mat.stiffness(m_x, m_box));
+  for ( auto &mat : m_potentialadhesion ) add(k, mat.particles(), mat.stiffness(m_x, m_box));
+  for ( auto &mat : m_dashpot           ) add(c, mat.particles(),
+    ColD( mat.eta().cwiseProduct(mat.active().cast<double>()) ));
+
+  // walls: a single (diagonal) block per particle in contact
+  for ( auto &wall : m_wall )
+  {
+    ColD kw = wall.stiffness(m_x, m_t);
+
+    for ( size_t i = 0 ; i < m_N ; ++i )
+      if ( kw(i) > 0.0 ) { k(i) += kw(i); c(i) += wall.eta(); }
+  }
+
+  // convert to DOFs
+  K = m_vec.assembleDofs(MatD(k.replicate(1,m_ndim)));
+  C = m_vec.assembleDofs(MatD(c.replicate(1,m_ndim)));
+
+  // ignore prescribed DOFs
+  for ( auto i = 0 ; i < m_iip.size() ; ++i ) { K(m_iip(i)) = 0.0; C(m_iip(i)) = 0.0; }
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline MatD Geometry::fext() const
+inline double Geometry::dt_crit() const
 {
-  return m_fext;
+  // stiffness and damping per DOF
+  ColD K, C;
+
+  dofs_KC(K, C);
+
+  // critical time step of each DOF (damped harmonic oscillator), keep the smallest
+  double dt = std::numeric_limits<double>::infinity();
+
+  for ( size_t d = 0 ; d < m_ndof ; ++d )
+  {
+    // - no stiffness: the limit "K -> 0" of the damped oscillator, "dt = 2 M / C"
+    if ( K(d) <= 0.0 )
+    {
+      if ( C(d) > 0.0 ) dt = std::min(dt, 2. * m_M(d) / C(d));
+      continue;
+    }
+
+    double omega = std::sqrt( K(d) / m_M(d) );
+    double xi    = C(d) / ( 2. * m_M(d) * omega );
+
+    dt = std::min(dt, 2. / omega * ( std::sqrt( 1. + xi*xi ) - xi ));
+  }
+
+  return dt;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline MatD Geometry::fres() const
+inline void Geometry::set_mass_scaling(MassScaling scaling, double dt)
 {
-  // compute internal and external force
-  ColD Fint = m_vec.assembleDofs( f()    );
-  ColD Fext = m_vec.assembleDofs( m_fext );
+  // check input
+  assert( scaling == MassScaling::none || dt > 0.0 );
 
-  // compute reaction forces, on the prescribed DOFs
-  for ( auto i = 0 ; i < m_iip.size() ; ++i ) Fext(m_iip(i)) = Fint(m_iip(i));
+  // store, and apply
+  m_scaling    = scaling;
+  m_scaling_dt = dt;
 
-  // return as particle vector
-  return m_vec.asParticle(Fext);
+  update_M();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline ColD Geometry::solve()
+inline void Geometry::update_M()
 {
-  // compute internal and external force
-  ColD Fint = m_vec.assembleDofs( f()    );
-  ColD Fext = m_vec.assembleDofs( m_fext );
+  // physical masses
+  m_M = m_vec.asDofs(m_m);
 
-  // solve system of equations
-  ColD A = m_Minv.cwiseProduct( Fint - Fext );
+  if ( m_scaling != MassScaling::none )
+  {
+    // stiffness and damping per DOF
+    ColD K, C;
 
-  // enforce fixed displacement of boundary DOFs
-  for ( auto i = 0 ; i < m_iip.size() ; ++i ) A(m_iip(i)) = 0.0;
+    dofs_KC(K, C);
 
-  // return acceleration of DOFs
-  return A;
+    // smallest mass for which the critical time step of each DOF (damped harmonic oscillator,
+    // central difference) is "dt": "M = K dt^2 / 4 + C dt / 2"
+    double dt = m_scaling_dt;
+
+    ColD M = K * (dt * dt / 4.) + C * (dt / 2.);
+
+    // uniform: the largest factor of all DOFs (with mass); selective: the mass of each DOF
+    if ( m_scaling == MassScaling::uniform )
+      m_M *= std::max(1.0, ( m_M.array() > 0.0 ).select(M.array() / m_M.array(), 0.0).maxCoeff());
+    else
+      m_M = m_M.cwiseMax(M);
+  }
+
+  update_Minv();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline void Geometry::reset()
+inline double Geometry::added_mass() const
 {
-  m_stop.reset();
+  ColD M = m_vec.asDofs(m_m);
+
+  return ( m_M.sum() - M.sum() ) / M.sum();
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline bool Geometry::stop(double tol)
+inline double Geometry::added_kinetic() const
 {
-  // compute internal and external force
-  ColD Fint = m_vec.assembleDofs( f()    );
-  ColD Fext = m_vec.assembleDofs( m_fext );
+  ColD M  = m_vec.asDofs(m_m);
+  ColD V2 = m_vec.asDofs(m_v).cwiseAbs2();
 
-  // compute reaction forces, on the prescribed DOFs
-  for ( auto i = 0 ; i < m_iip.size() ; ++i ) Fext(m_iip(i)) = Fint(m_iip(i));
+  double T = m_M.dot(V2);
 
-  // compute residual force
-  ColD Res = Fint - Fext;
+  if ( T <= 0.0 ) return 0.0;
 
-  // sum of absolute
-  double res  = Res .cwiseAbs().sum();
-  double fext = Fext.cwiseAbs().sum();
+  return ( T - M.dot(V2) ) / T;
+}
 
-  // normalize
-  if ( fext != 0 ) res /= fext;
+// -------------------------------------------------------------------------------------------------
 
-  // check to stop
-  bool stop = m_stop.stop(res, tol);
+inline double Geometry::kinetic() const
+{
+  ColD V = m_vec.asDofs(m_v);
 
-  // if stop: reset for next increment
-  if ( stop )
+  return .5 * m_M.dot( V.cwiseProduct(V) );
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline double Geometry::potential() const
+{
+  // constitutive models
+  double E = 0.0;
+
+  for ( auto &mat : m_spring            ) E += mat.potential(m_x, m_box).sum();
+  for ( auto &mat : m_potentialadhesion ) E += mat.potential(m_x, m_box).sum();
+
+  // walls (excluding the vacant slots)
+  for ( auto &wall : m_wall )
   {
-    // - reset residuals to infinity
-    m_stop.reset();
-    // - ground system
-    m_v.setZero();
-    m_a.setZero();
+    ColD e = wall.potential(m_x, m_t);
+
+    for ( auto &n : m_vacant ) e(n) = 0.0;
+
+    E += e.sum();
   }
 
-  return stop;
+  // external force (which enters the equation of motion with a minus sign)
+  E += m_fext.cwiseProduct(m_x).sum();
+
+  return E;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline void Geometry::timestep(double dt)
+inline double Geometry::energy() const
 {
-  m_t += dt;
+  return kinetic() + potential();
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -219,30 +1140,172 @@ inline ColD Geometry::m() const
 
 inline MatD Geometry::f() const
 {
-  // zero-initialize force vector per particle
-  MatD f = MatD::Zero(m_N, m_ndim);
+  return force(0, true);
+}
 
-  // evaluate constitutive models
-  f += m_spring           .force(m_x);
-  f += m_dashpot          .force(m_v);
-  f += m_potentialadhesion.force(m_x);
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Geometry::f(size_t level) const
+{
+  return force(level, false);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Geometry::force(size_t level, bool all, const std::function<void()> &extra) const
+{
+  // list the constitutive models to evaluate, each writes the force to its own buffer: a pair
+  // model with at least "m_nconcurrent" pairs is split into ranges of pairs of the same color
+  // (see "force_colored"), the other models (and the walls) are evaluated as one task each
+  std::vector<std::function<void(MatD &)>> models;
+  std::vector<bool> split;
+
+  size_t npair = 0;
+
+  auto add = [&](const Topology &topology, std::function<void(MatD &)> whole,
+    std::function<void(const Index*, size_t, MatD &)> kernel)
+  {
+    split.push_back(topology.size() >= m_nconcurrent);
+
+    if ( split.back() )
+      models.push_back([this,&topology,kernel](MatD &f){ force_colored(topology, kernel, f); });
+    else
+      models.push_back(std::move(whole));
+
+    npair += topology.size();
+  };
+
+  for ( size_t i = 0 ; i < m_spring.size() ; ++i )
+  {
+    if ( ! all && m_level_spring[i] != level ) continue;
+
+    const Spring &mat = m_spring[i];
+
+    add(*mat.topology(),
+      [this,&mat](MatD &f){ f = mat.force(m_x, m_box); },
+      [this,&mat](const Index *index, size_t m, MatD &f){ mat.force(m_x, m_box, index, m, f); });
+  }
+
+  for ( size_t i = 0 ; i < m_dashpot.size() ; ++i )
+  {
+    if ( ! all && m_level_dashpot[i] != level ) continue;
+
+    const Dashpot &mat = m_dashpot[i];
+
+    add(*mat.topology(),
+      [this,&mat](MatD &f){ f = mat.force(m_x, m_v, m_box); },
+      [this,&mat](const Index *index, size_t m, MatD &f){
+        mat.force(m_x, m_v, m_box, index, m, f); });
+  }
+
+  for ( size_t i = 0 ; i < m_potentialadhesion.size() ; ++i )
+  {
+    if ( ! all && m_level_potentialadhesion[i] != level ) continue;
+
+    const PotentialAdhesion &mat = m_potentialadhesion[i];
+
+    add(*mat.topology(),
+      [this,&mat](MatD &f){ f = mat.force(m_x, m_box); },
+      [this,&mat](const Index *index, size_t m, MatD &f){ mat.force(m_x, m_box, index, m, f); });
+  }
+
+  for ( size_t i = 0 ; i < m_wall.size() ; ++i )
+  {
+    if ( ! all && m_level_wall[i] != level ) continue;
+
+    models.push_back([this,i](MatD &f){ f = wall_force(i); });
+    split.push_back(false);
+
+    npair += m_N;
+  }
+
+  // evaluate the models that are not split (and the extra task) concurrently, if the work is large
+  // enough
+  std::vector<MatD> buffer(models.size());
+  std::vector<size_t> task;
+
+  for ( size_t i = 0 ; i < models.size() ; ++i )
+    if ( ! split[i] )
+      task.push_back(i);
+
+  size_t n = task.size();
+
+  parallel_for(extra ? n+1 : n, nthread(npair), [&](size_t i)
+  {
+    if ( i < n ) models[task[i]](buffer[task[i]]);
+    else         extra();
+  });
+
+  // evaluate the split models, one after the other (each uses all threads)
+  for ( size_t i = 0 ; i < models.size() ; ++i )
+    if ( split[i] )
+      models[i](buffer[i]);
+
+  // sum the constitutive models, in a fixed order (in parallel over ranges of particles)
+  MatD f(m_N, m_ndim);
+
+  parallel_range(m_N, m_grain, nthread(npair), [&](size_t begin, size_t end)
+  {
+    auto fi = f.middleRows(begin, end-begin);
+
+    fi.setZero();
+
+    for ( auto &bi : buffer ) fi += bi.middleRows(begin, end-begin);
+  });
 
   return f;
 }
 
 // -------------------------------------------------------------------------------------------------
 
+inline void Geometry::force_colored(const Topology &topology,
+  const std::function<void(const Index*, size_t, MatD &)> &kernel, MatD &f) const
+{
+  // zero-initialize force per particle
+  f = MatD::Zero(m_N, m_ndim);
+
+  // pairs per color (the coloring is computed on first use)
+  const ColS &offset  = topology.color_offset();
+  const ColS &colored = topology.colored();
+
+  // the pairs of one color do not share a particle: add them in parallel ranges to the same buffer,
+  // each particle receives the contributions of the colors in a fixed order
+  for ( size_t c = 0 ; c < topology.ncolor() ; ++c )
+  {
+    const Index *index = colored.data() + offset(c);
+
+    parallel_range(offset(c+1) - offset(c), m_grain, m_nthread, [&](size_t begin, size_t end)
+    {
+      kernel(index + begin, end - begin, f);
+    });
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Geometry::nthread(size_t n) const
+{
+  return n >= m_nconcurrent ? m_nthread : 1;
+}
+
+// -------------------------------------------------------------------------------------------------
+
 inline ColS Geometry::coordination() const
+{
+  return m_coordination;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Geometry::update_coordination()
 {
   // zero-initialize coordinations column per particle
-  ColS c = ColS::Zero(m_N);
+  m_coordination = ColS::Zero(m_N);
 
   // evaluate constitutive models
-  c += m_spring           .coordination(m_x);
-  c += m_dashpot          .coordination(m_x);
-  c += m_potentialadhesion.coordination(m_x);
-
-  return c;
+  for ( auto &mat : m_spring            ) m_coordination += mat.coordination(m_x);
+  for ( auto &mat : m_dashpot           ) m_coordination += mat.coordination(m_x);
+  for ( auto &mat : m_potentialadhesion ) m_coordination += mat.coordination(m_x);
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -263,7 +1326,7 @@ inline ColD Geometry::dofs_a() const
 
 inline ColD Geometry::dofs_m() const
 {
-  return m_vec.asDofs(m_m);
+  return m_M;
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -275,6 +1338,65 @@ inline ColD Geometry::dofs_f() const
 
 // -------------------------------------------------------------------------------------------------
 
+inline ColS Geometry::iip() const
+{
+  return m_iip;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Geometry::iip_fixed() const
+{
+  return m_iip.head(m_np);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline SpMatD Geometry::dofs_K() const
+{
+  SpMatD K(m_ndof, m_ndof);
+
+  for ( auto &mat : m_spring )
+    K += m_vec.assembleSparse(mat.particles(), mat.tangent(m_x, m_box));
+
+  for ( auto &mat : m_potentialadhesion )
+    K += m_vec.assembleSparse(mat.particles(), mat.tangent(m_x, m_box));
+
+  for ( auto &wall : m_wall )
+  {
+    MatD Kw = wall.tangent(m_x, m_v, m_t);
+
+    for ( auto &n : m_vacant ) Kw.row(n).setZero();
+
+    K += m_vec.assembleSparse(Kw);
+  }
+
+  return K;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline SpMatD Geometry::dofs_C() const
+{
+  SpMatD C(m_ndof, m_ndof);
+
+  for ( auto &mat : m_dashpot )
+    C += m_vec.assembleSparse(mat.particles(), mat.tangent(m_v));
+
+  for ( auto &wall : m_wall )
+  {
+    MatD Cw = wall.damping(m_x, m_v, m_t);
+
+    for ( auto &n : m_vacant ) Cw.row(n).setZero();
+
+    C += m_vec.assembleSparse(Cw);
+  }
+
+  return C;
+}
+
+// -------------------------------------------------------------------------------------------------
+
 inline void Geometry::set_x(const MatD &pvector)
 {
   // check input
@@ -345,6 +1467,41 @@ inline void Geometry::set_a(const ColD &Ain)
 
 // -------------------------------------------------------------------------------------------------
 
+inline MatD Geometry::asParticle(const ColD &dofval) const
+{
+  return m_vec.asParticle(dofval);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD* Geometry::view_x()
+{
+  return &m_x;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD* Geometry::view_v()
+{
+  return &m_v;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD* Geometry::view_a()
+{
+  return &m_a;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const MatS* Geometry::view_dofs() const
+{
+  return &m_dofs;
+}
+
+// -------------------------------------------------------------------------------------------------
+
 }}} // namespace ...
 
 // -------------------------------------------------------------------------------------------------
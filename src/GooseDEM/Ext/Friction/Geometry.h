@@ -24,7 +24,17 @@ namespace Friction {
 
 // -------------------------------------------------------------------------------------------------
 
-class Geometry : public GooseDEM::Geometry
+// scaling of the DOF masses, for quasi-static relaxation (where the inertia is fictitious)
+enum class MassScaling
+{
+  none,     // physical masses
+  uniform,  // all masses by the same factor
+  selective // each DOF by its own factor, based on its stiffness and damping
+};
+
+// -------------------------------------------------------------------------------------------------
+
+class Geometry final : public GooseDEM::Geometry
 {
 private:
 
@@ -39,39 +49,158 @@ private:
   ColD m_m;      // mass           [N, ndim]
   MatS m_dofs;   // DOF-number     [N, ndim]
 
-  // prescribed DOFs
-  ColS m_iip;    // DOF-numbers         [np]
-  ColD m_vp;     // prescribed velocity [np]
+  // prescribed DOFs: those set by "fix_v" ("m_np"), followed by those of the vacant slots
+  ColS   m_iip;  // DOF-numbers         [np]
+  ColD   m_vp;   // prescribed velocity [np]
+  size_t m_np;   // number of DOFs set by "fix_v"
+
+  // vacant particle slots (removed particles and reserved capacity), reused by "insert" from the
+  // back; they have zero mass, no interactions, and their DOFs are prescribed at zero velocity
+  std::vector<size_t> m_vacant;
 
   // DOF values
-  ColD m_M;      // mass            [ndof]
-  ColD m_Minv;   // inverse of mass [ndof]
+  ColD m_M;      // mass (possibly scaled) [ndof]
+  ColD m_Minv;   // inverse of mass        [ndof]
+
+  // mass scaling, reapplied when particles or interactions are added
+  MassScaling m_scaling;
+  double      m_scaling_dt;
+
+  // periodic box
+  Periodic m_box;
+
+  // coordination of each particle (sum over the constitutive models) [N]
+  ColS m_coordination;
+
+  // broken pairs: during the last time step [nbroken, 2], and the fraction of broken pairs of a
+  // constitutive model at which they are removed from it
+  MatS   m_broken;
+  double m_compact;
 
   // time & convergence check
   double   m_t;
   StopList m_stop;
 
   // dimensions
-  size_t m_N;    // number of particles
+  size_t m_N;    // number of particles (including vacant slots)
   size_t m_ndim; // number of spatial dimensions
   size_t m_ndof; // number of DOFs
 
-  // constitutive models
-  Spring            m_spring;
-  Dashpot           m_dashpot;
-  PotentialAdhesion m_potentialadhesion;
+  // constitutive models (any number of each type)
+  std::vector<Spring>            m_spring;
+  std::vector<Dashpot>           m_dashpot;
+  std::vector<PotentialAdhesion> m_potentialadhesion;
 
-public:
+  // level of each constitutive model in a multiple-time-stepping scheme (0: fast, 1: slow)
+  std::vector<size_t> m_level_spring;
+  std::vector<size_t> m_level_dashpot;
+  std::vector<size_t> m_level_potentialadhesion;
 
-  // constructor
-  Geometry(const ColD &m, const MatD &x, const MatS &dofs);
+  // analytic walls (interact with all particles), and their level
+  std::vector<Wall>   m_wall;
+  std::vector<size_t> m_level_wall;
 
-  // append constitutive models
-  void set(const Spring            &mat);
-  void set(const Dashpot           &mat);
-  void set(const PotentialAdhesion &mat);
+  // number of threads used to evaluate the constitutive models concurrently, and the minimal
+  // (total) number of pairs (or DOFs) for which this is done; loops over particles and DOFs are
+  // split into ranges of "m_grain" items
+  size_t m_nthread;
+  size_t m_nconcurrent;
+  size_t m_grain;
 
-  // set fixed velocity
+public:
+
+  // constructor
+  Geometry(ColD m, MatD x, MatS dofs);
+
+  // set constitutive models (replaces all models of the same type), optionally at the slow level
+  // ("level=1") of a multiple-time-stepping scheme (see "RESPA", which integrates levels 0 and 1)
+  void set(const Spring            &mat, size_t level=0);
+  void set(const Dashpot           &mat, size_t level=0);
+  void set(const PotentialAdhesion &mat, size_t level=0);
+
+  // append constitutive models (e.g. a second family of springs), optionally at the slow level
+  // ("level=1") of a multiple-time-stepping scheme
+  void add(const Spring            &mat, size_t level=0);
+  void add(const Dashpot           &mat, size_t level=0);
+  void add(const PotentialAdhesion &mat, size_t level=0);
+
+  // append the pairs of a constitutive model to the "index"-th model of the same type (e.g. the
+  // interactions of inserted particles), instead of adding a model: no extra force buffer or pass
+  // over the particles. If that model stores its parameters per type, the pairs must refer to the
+  // same table.
+  void append(const Spring            &mat, size_t index=0);
+  void append(const Dashpot           &mat, size_t index=0);
+  void append(const PotentialAdhesion &mat, size_t index=0);
+
+  // return the number of constitutive models
+  size_t nmodel() const;
+
+  // set (replaces all walls) or append analytic walls, optionally at the slow level ("level=1") of
+  // a multiple-time-stepping scheme; the walls move with the time of the geometry
+  void set(const Wall &wall, size_t level=0);
+  void add(const Wall &wall, size_t level=0);
+
+  // return the number of walls
+  size_t nwall() const;
+
+  // return the reaction force on each wall (minus the sum of the force of the wall on the
+  // particles) [nwall, ndim]
+  MatD wall_reaction() const;
+
+  // set the number of threads used to evaluate the constitutive models concurrently (default: the
+  // number of hardware threads), and the minimal total number of pairs for which this is done
+  // (default: 10000). Each model is evaluated into its own buffer, the buffers are summed in the
+  // order in which the models were added. A model with at least "nconcurrent" pairs is itself split
+  // into ranges of pairs that do not share a particle (the colors of its topology, see
+  // "Topology::colored"), that are evaluated concurrently; the result does not depend on the
+  // number of threads (but it does on "nconcurrent"). The threads are those of the shared
+  // "GooseDEM::pool()".
+  void set_nthread(size_t nthread, size_t nconcurrent=10000);
+
+  // set the fraction of broken pairs of a constitutive model at which the broken pairs are removed
+  // from it (default: 0.1)
+  void set_compaction(double fraction);
+
+  // scale the DOF masses such that the critical time step is "dt" (for quasi-static relaxation):
+  // "uniform" scales all masses by the same factor, "selective" raises the mass of each DOF with
+  // a smaller critical time step to that of "dt". The masses are never reduced, and are based on
+  // the stiffness in the current configuration. The scaling is reapplied by "insert" and when a
+  // constitutive model or wall is added. "MassScaling::none" restores the physical masses.
+  void set_mass_scaling(MassScaling scaling, double dt=0.0);
+
+  // return the added mass (as a fraction of the physical mass), and the fraction of the kinetic
+  // energy that is due to the added mass
+  double added_mass()    const;
+  double added_kinetic() const;
+
+  // insert particles, with position [k, ndim], mass [k], and (optionally) velocity [k, ndim], in
+  // vacant slots; if needed the capacity is doubled, with new DOFs for the new slots. Return the
+  // particle numbers [k]. The interactions of the new particles are added to the constitutive
+  // models with "append" (or as new constitutive models with "add").
+  ColS insert(const MatD &x, const ColD &m, const MatD &v=MatD());
+
+  // remove particles [k]: their pairs are deactivated in all constitutive models (which are
+  // compacted as after rupture), their slots become vacant. The particles must have their own
+  // DOFs (not shared with other particles, nor prescribed by "fix_v").
+  void remove(const ColS &particles);
+
+  // reserve capacity for (at least) "N" particles (including the current vacant slots)
+  void reserve(size_t N);
+
+  // move the particles to the first slots, by moving the last particle to the first vacant slot
+  // until all vacant slots are at the end (swap-remove; the particles keep their DOFs, the models
+  // are renumbered and their broken pairs removed). Return the former number of each slot [N].
+  ColS compact();
+
+  // return the vacant slots (the next "insert" fills them from the back), and their number
+  ColS   vacant()  const;
+  size_t nvacant() const;
+
+  // set periodic box (used by all constitutive models), return periodic box
+  void     set(const Periodic &box);
+  Periodic box() const;
+
+  // set fixed velocity (applied directly to the particle velocities)
   void fix_v(const ColS &iip, const ColD &vp);
 
   // set external force
@@ -84,26 +213,56 @@ public:
   // solve for DOF-accelerations [ndof]
   ColD solve() override;
 
+  // solve for DOF-accelerations [ndof], due only to the constitutive models at "level" (the
+  // external force is applied at level 0)
+  ColD solve_level(size_t level) override;
+
   // reset residuals, check for convergence
   void reset() override;
   bool stop(double tol) override;
 
-  // process time-step
+  // process time-step (break the springs and adhesive pairs that exceed their breaking criterion,
+  // the dashpots that share the topology of the springs break with them)
   void timestep(double dt) override;
 
+  // return the particle pairs that broke during the last time step [nbroken, 2]
+  MatS broken() const;
+
+  // estimate the critical time step, from the stiffness and damping of the constitutive models
+  // and the DOF masses (a DOF with only damping limits the time step to "2 M / C")
+  double dt_crit() const override;
+
+  // return the kinetic energy, the potential energy (constitutive models, walls, and external
+  // force), and their sum
+  double kinetic()   const;
+  double potential() const override;
+  double energy()    const override;
+
   // return particle vectors [N, ndim]
   MatD x()            const override;
   MatD v()            const override;
   MatD a()            const override;
   MatD f()            const;
-  ColS coordination() const;
+  MatD f(size_t level) const; // only the constitutive models at "level"
+  ColS coordination() const override;
   ColD m()            const;
 
-  // return DOF values [ndof]
+  // return DOF values [ndof] (the masses include the mass scaling)
   ColD dofs_v() const override;
   ColD dofs_a() const override;
   ColD dofs_f() const;
-  ColD dofs_m() const;
+  ColD dofs_m() const override;
+
+  // return the prescribed DOFs [np]: those set by "fix_v", followed by those of the vacant slots
+  ColS iip() const override;
+
+  // return the DOFs set by "fix_v" (in the same order), without those of the vacant slots
+  ColS iip_fixed() const;
+
+  // return the tangent stiffness (springs, adhesion, and walls) and damping (dashpots and walls)
+  // [ndof, ndof]
+  SpMatD dofs_K() const override;
+  SpMatD dofs_C() const override;
 
   // overwrite particle vectors [N, ndim]
   void set_x(const MatD &pvector) override;
@@ -114,6 +273,63 @@ public:
   void set_v(const ColD &dofval) override; // == set_v(asParticle(V))
   void set_a(const ColD &dofval) override; // == set_a(asParticle(A))
 
+  // reconstruct a particle vector from DOF values: [ndof] -> [N, ndim]
+  MatD asParticle(const ColD &dofval) const override;
+
+  // mutable views of the particle vectors, and the DOF-numbers [N, ndim]
+  MatD*       view_x()          override;
+  MatD*       view_v()          override;
+  MatD*       view_a()          override;
+  const MatS* view_dofs() const override;
+
+private:
+
+  // recompute the coordination (after changing a constitutive model)
+  void update_coordination();
+
+  // sum the force of the constitutive models at "level" (or of all models if "all=true"), an
+  // independent "extra" task is evaluated concurrently with the constitutive models (on a thread of
+  // the pool: it must not start threads, or change global settings such as those of Eigen)
+  MatD force(size_t level, bool all, const std::function<void()> &extra=nullptr) const;
+
+  // compute the force of a pair model on the particles [N, ndim], by adding the pairs of each color
+  // of "topology" in concurrent ranges: "kernel(index, m, f)" adds the force of the pairs "index"
+  // [m] to "f" (the result does not depend on the number of threads)
+  void force_colored(const Topology &topology,
+    const std::function<void(const Index*, size_t, MatD &)> &kernel, MatD &f) const;
+
+  // compute the force of wall "i" on the particles (zero for the vacant slots) [N, ndim]
+  MatD wall_force(size_t i) const;
+
+  // compute the DOF-accelerations "Minv * (Fint - Fext)"
+  ColD scale(const ColD &Fint, const ColD &Fext) const;
+
+  // sum the stiffness and damping of the constitutive models and the walls per DOF [ndof] (an upper
+  // bound of the eigenvalues of the tangent, Gershgorin), zero at the prescribed DOFs
+  void dofs_KC(ColD &K, ColD &C) const;
+
+  // number of threads to use for "n" items of work
+  size_t nthread(size_t n) const;
+
+  // break pairs that exceed their breaking criterion, compact the constitutive models
+  void rupture();
+
+  // remove the broken pairs from the constitutive models in which their fraction exceeds
+  // "fraction" (dashpots that share the topology of a spring are compacted with it)
+  void compact_models(double fraction);
+
+  // append vacant slots (with new DOFs) up to "N" particles
+  void grow(size_t N);
+
+  // prescribe the DOFs set by "fix_v" and those of the vacant slots
+  void update_iip();
+
+  // compute the DOF masses: the physical masses, scaled as set by "set_mass_scaling"
+  void update_M();
+
+  // compute the inverse of the DOF masses (zero for vacant slots)
+  void update_Minv();
+
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -0,0 +1,876 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_EXT_FRICITION_GEOMETYMPI_CPP
+#define GOOSEDEM_EXT_FRICITION_GEOMETYMPI_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "GeometryMPI.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+namespace Ext {
+namespace Friction {
+
+// -------------------------------------------------------------------------------------------------
+
+inline GeometryMPI::GeometryMPI(
+  MPI_Comm comm, const ColD &m, const MatD &x, const MatS &dofs, const ColS &global) :
+  m_comm(comm), m_global(global)
+{
+  // communicator
+  MPI_Comm_rank(m_comm, &m_rank);
+  MPI_Comm_size(m_comm, &m_size);
+
+  // extract dimensions
+  m_N    = static_cast<size_t>(dofs.rows());
+  m_ng   = 0;
+  m_ndim = static_cast<size_t>(dofs.cols());
+
+  // check input
+  assert( static_cast<size_t>(x     .rows()) == m_N    );
+  assert( static_cast<size_t>(x     .cols()) == m_ndim );
+  assert( static_cast<size_t>(m     .size()) == m_N    );
+  assert( static_cast<size_t>(global.size()) == m_N    );
+
+  // check that each process owns at least one particle, in increasing global particle number
+  assert( m_N > 0 );
+  assert( std::is_sorted(global.data(), global.data()+m_N) );
+
+  // total number of particles
+  unsigned long long Nglob = m_N;
+  MPI_Allreduce(MPI_IN_PLACE, &Nglob, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, m_comm);
+  m_Nglob = static_cast<size_t>(Nglob);
+
+  // local particle numbers of the owned particles
+  for ( size_t n = 0 ; n < m_N ; ++n )
+    m_local[global(n)] = n;
+
+  // global DOF-numbers of the owned particles (sorted, unique)
+  std::vector<size_t> gdofs(dofs.data(), dofs.data()+dofs.size());
+
+  std::sort(gdofs.begin(), gdofs.end());
+  gdofs.erase(std::unique(gdofs.begin(), gdofs.end()), gdofs.end());
+
+  m_ndof  = gdofs.size();
+  m_gdofs = ColS(m_ndof);
+
+  for ( size_t d = 0 ; d < m_ndof ; ++d )
+    m_gdofs(d) = gdofs[d];
+
+  // register the owned particles and DOFs in the directory (number "i" on process "i % size")
+  std::vector<std::vector<size_t>> particles(m_size);
+  std::vector<std::vector<size_t>> dofnumbers(m_size);
+
+  for ( size_t n = 0 ; n < m_N    ; ++n ) particles [global(n) % m_size].push_back(global(n));
+  for ( size_t d = 0 ; d < m_ndof ; ++d ) dofnumbers[gdofs[d]  % m_size].push_back(gdofs[d] );
+
+  particles  = alltoall(particles);
+  dofnumbers = alltoall(dofnumbers);
+
+  // check that each particle is owned by one process
+  bool error = false;
+
+  for ( int q = 0 ; q < m_size ; ++q )
+    for ( auto &n : particles[q] )
+      if ( n >= m_Nglob || ! m_directory.emplace(n, q).second )
+        error = true;
+
+  check(error, "GooseDEM::Ext::Friction::GeometryMPI: particle numbers not unique or out-of-range");
+
+  // check that particles that share a DOF are owned by the same process (each process sends its
+  // DOFs once)
+  std::unordered_set<size_t> registered;
+
+  for ( auto &list : dofnumbers )
+    for ( auto &d : list )
+      if ( ! registered.insert(d).second )
+        error = true;
+
+  check(error, "GooseDEM::Ext::Friction::GeometryMPI: shared DOF on different processes");
+
+  // local particle vectors
+  m_x    = x;
+  m_m    = m;
+  m_dofs = MatS(m_N, m_ndim);
+
+  for ( size_t n = 0 ; n < m_N ; ++n )
+    for ( size_t i = 0 ; i < m_ndim ; ++i )
+      m_dofs(n,i) = std::lower_bound(gdofs.begin(), gdofs.end(), dofs(n,i)) - gdofs.begin();
+
+  // conversion vector
+  m_vec  = Vector(m_dofs);
+
+  // zero-initialize particle vectors
+  m_v    = MatD::Zero(m_N, m_ndim);
+  m_a    = MatD::Zero(m_N, m_ndim);
+
+  // zero-initialize boundary conditions
+  m_iip  = ColS();
+  m_vp   = ColD();
+  m_fext = MatD::Zero(m_N, m_ndim);
+
+  // zero-initialize time
+  m_t    = 0.0;
+
+  // empty halo exchange plan
+  m_send.resize(m_size);
+  m_recv.resize(m_size);
+
+  // compute (inverse of) DOF masses
+  m_M    = m_vec.asDofs(m_m);
+  m_Minv = m_M.cwiseInverse();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::vector<std::vector<size_t>> GeometryMPI::alltoall(
+  const std::vector<std::vector<size_t>> &send) const
+{
+  // number of entries to send to, and to receive from, each process
+  std::vector<int> scount(m_size);
+  std::vector<int> rcount(m_size);
+
+  for ( int q = 0 ; q < m_size ; ++q )
+    scount[q] = static_cast<int>(send[q].size());
+
+  MPI_Alltoall(scount.data(), 1, MPI_INT, rcount.data(), 1, MPI_INT, m_comm);
+
+  // offsets
+  std::vector<int> soff(m_size, 0);
+  std::vector<int> roff(m_size, 0);
+
+  for ( int q = 1 ; q < m_size ; ++q )
+  {
+    soff[q] = soff[q-1] + scount[q-1];
+    roff[q] = roff[q-1] + rcount[q-1];
+  }
+
+  // communicate
+  std::vector<unsigned long long> sbuf(soff.back() + scount.back());
+  std::vector<unsigned long long> rbuf(roff.back() + rcount.back());
+
+  for ( int q = 0 ; q < m_size ; ++q )
+    std::copy(send[q].begin(), send[q].end(), sbuf.begin() + soff[q]);
+
+  MPI_Alltoallv(sbuf.data(), scount.data(), soff.data(), MPI_UNSIGNED_LONG_LONG,
+                rbuf.data(), rcount.data(), roff.data(), MPI_UNSIGNED_LONG_LONG, m_comm);
+
+  // split per process
+  std::vector<std::vector<size_t>> out(m_size);
+
+  for ( int q = 0 ; q < m_size ; ++q )
+    out[q].assign(rbuf.begin() + roff[q], rbuf.begin() + roff[q] + rcount[q]);
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::check(bool error, const char *message) const
+{
+  int local  = error ? 1 : 0;
+  int global = 0;
+
+  MPI_Allreduce(&local, &global, 1, MPI_INT, MPI_MAX, m_comm);
+
+  if ( global ) throw std::runtime_error(message);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS GeometryMPI::ghosts(const MatS &particles)
+{
+  // interactions owned by this process, and new ghosts
+  std::vector<size_t> index;
+  std::vector<size_t> add;
+
+  // number of local particles
+  size_t nlocal = m_N + m_ng;
+
+  // loop over all interactions, select those of which the first particle is owned
+  for ( auto p = 0 ; p < particles.rows() ; ++p )
+  {
+    auto i = m_local.find(particles(p,0));
+
+    if ( i == m_local.end() || i->second >= m_N ) continue;
+
+    index.push_back(p);
+
+    // - particle "j" is a new ghost
+    if ( m_local.emplace(particles(p,1), nlocal+add.size()).second )
+      add.push_back(particles(p,1));
+  }
+
+  // ask the directory for the owner of the new ghosts
+  std::vector<std::vector<size_t>> query(m_size);
+
+  for ( auto &n : add ) query[n % m_size].push_back(n);
+
+  std::vector<std::vector<size_t>> owner = alltoall(query);
+
+  bool error = false;
+
+  for ( auto &list : owner )
+  {
+    for ( auto &n : list )
+    {
+      auto it = m_directory.find(n);
+
+      if ( it == m_directory.end() ) { error = true; n = 0; }
+      else                           { n = it->second;      }
+    }
+  }
+
+  owner = alltoall(owner);
+
+  check(error, "GooseDEM::Ext::Friction::GeometryMPI: interaction with an unknown particle");
+
+  // request the new ghosts from their owner, who sends them in the order of the request
+  std::vector<std::vector<size_t>> request(m_size);
+
+  for ( int q = 0 ; q < m_size ; ++q )
+  {
+    for ( size_t k = 0 ; k < query[q].size() ; ++k )
+    {
+      request[owner[q][k]].push_back(query[q][k]);
+      m_recv [owner[q][k]].push_back(m_local.at(query[q][k]));
+    }
+  }
+
+  request = alltoall(request);
+
+  for ( int q = 0 ; q < m_size ; ++q )
+    for ( auto &n : request[q] )
+      m_send[q].push_back(m_local.at(n));
+
+  // store new ghosts, after the existing local particles
+  m_x     .conservativeResize(nlocal+add.size(), m_ndim);
+  m_v     .conservativeResize(nlocal+add.size(), m_ndim);
+  m_global.conservativeResize(nlocal+add.size());
+
+  for ( size_t n = 0 ; n < add.size() ; ++n )
+  {
+    m_x.row(nlocal+n).setZero();
+    m_v.row(nlocal+n).setZero();
+
+    m_global(nlocal+n) = add[n];
+  }
+
+  m_ng += add.size();
+
+  // return owned interactions
+  ColS out(index.size());
+
+  for ( size_t p = 0 ; p < index.size() ; ++p )
+    out(p) = index[p];
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatS GeometryMPI::renumber(const MatS &particles, const ColS &index) const
+{
+  MatS out(index.size(), particles.cols());
+
+  for ( auto p = 0 ; p < index.size() ; ++p )
+    for ( auto i = 0 ; i < particles.cols() ; ++i )
+      out(p,i) = m_local.at(particles(index(p),i));
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::set(const Spring &mat)
+{
+  ColS index = ghosts(mat.particles());
+
+  // select the owned interactions, keeping the parameters (or the parameter table) of the model
+  m_spring = mat;
+  m_spring.compact(std::make_shared<const Topology>(renumber(mat.particles(), index)), index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::set(const Dashpot &mat)
+{
+  ColS index = ghosts(mat.particles());
+
+  // select the owned interactions, keeping the parameters (or the parameter table) of the model
+  m_dashpot = mat;
+  m_dashpot.compact(std::make_shared<const Topology>(renumber(mat.particles(), index)), index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::set(const PotentialAdhesion &mat)
+{
+  ColS index = ghosts(mat.particles());
+
+  // select the owned interactions, keeping the parameters (or the parameter table) of the model
+  m_potentialadhesion = mat;
+  m_potentialadhesion.compact(std::make_shared<const Topology>(renumber(mat.particles(), index)),
+    index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::set(const Periodic &box)
+{
+  m_box = box;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::forward(MatD &pvector) const
+{
+  // number of components per particle
+  size_t ncol = static_cast<size_t>(pvector.cols());
+
+  // buffers and requests
+  std::vector<std::vector<double>> sbuf(m_size);
+  std::vector<std::vector<double>> rbuf(m_size);
+  std::vector<MPI_Request>         req;
+
+  req.reserve(2*m_size);
+
+  // receive ghosts
+  for ( int q = 0 ; q < m_size ; ++q )
+  {
+    if ( m_recv[q].size() == 0 ) continue;
+
+    rbuf[q].resize(m_recv[q].size()*ncol);
+    req.emplace_back();
+    MPI_Irecv(rbuf[q].data(), rbuf[q].size(), MPI_DOUBLE, q, 0, m_comm, &req.back());
+  }
+
+  // send owned particles
+  for ( int q = 0 ; q < m_size ; ++q )
+  {
+    if ( m_send[q].size() == 0 ) continue;
+
+    sbuf[q].resize(m_send[q].size()*ncol);
+
+    for ( size_t n = 0 ; n < m_send[q].size() ; ++n )
+      for ( size_t i = 0 ; i < ncol ; ++i )
+        sbuf[q][n*ncol+i] = pvector(m_send[q][n],i);
+
+    req.emplace_back();
+    MPI_Isend(sbuf[q].data(), sbuf[q].size(), MPI_DOUBLE, q, 0, m_comm, &req.back());
+  }
+
+  // wait for communication to finish
+  MPI_Waitall(req.size(), req.data(), MPI_STATUSES_IGNORE);
+
+  // store ghosts
+  for ( int q = 0 ; q < m_size ; ++q )
+    for ( size_t n = 0 ; n < m_recv[q].size() ; ++n )
+      for ( size_t i = 0 ; i < ncol ; ++i )
+        pvector(m_recv[q][n],i) = rbuf[q][n*ncol+i];
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::reverse(MatD &pvector) const
+{
+  // number of components per particle
+  size_t ncol = static_cast<size_t>(pvector.cols());
+
+  // buffers and requests
+  std::vector<std::vector<double>> sbuf(m_size);
+  std::vector<std::vector<double>> rbuf(m_size);
+  std::vector<MPI_Request>         req;
+
+  req.reserve(2*m_size);
+
+  // receive contributions to owned particles
+  for ( int q = 0 ; q < m_size ; ++q )
+  {
+    if ( m_send[q].size() == 0 ) continue;
+
+    rbuf[q].resize(m_send[q].size()*ncol);
+    req.emplace_back();
+    MPI_Irecv(rbuf[q].data(), rbuf[q].size(), MPI_DOUBLE, q, 1, m_comm, &req.back());
+  }
+
+  // send ghosts
+  for ( int q = 0 ; q < m_size ; ++q )
+  {
+    if ( m_recv[q].size() == 0 ) continue;
+
+    sbuf[q].resize(m_recv[q].size()*ncol);
+
+    for ( size_t n = 0 ; n < m_recv[q].size() ; ++n )
+      for ( size_t i = 0 ; i < ncol ; ++i )
+        sbuf[q][n*ncol+i] = pvector(m_recv[q][n],i);
+
+    req.emplace_back();
+    MPI_Isend(sbuf[q].data(), sbuf[q].size(), MPI_DOUBLE, q, 1, m_comm, &req.back());
+  }
+
+  // wait for communication to finish
+  MPI_Waitall(req.size(), req.data(), MPI_STATUSES_IGNORE);
+
+  // add contributions (in a fixed order: the result does not depend on the order of arrival)
+  for ( int q = 0 ; q < m_size ; ++q )
+    for ( size_t n = 0 ; n < m_send[q].size() ; ++n )
+      for ( size_t i = 0 ; i < ncol ; ++i )
+        pvector(m_send[q][n],i) += rbuf[q][n*ncol+i];
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::fix_v(const ColS &iip, const ColD &vp)
+{
+  // check input
+  assert( iip.size() == vp.size() );
+
+  // select the local DOFs
+  std::vector<size_t> i_iip;
+  std::vector<double> i_vp;
+
+  for ( auto i = 0 ; i < iip.size() ; ++i )
+  {
+    auto d = std::lower_bound(m_gdofs.data(), m_gdofs.data()+m_ndof, iip(i));
+
+    if ( d == m_gdofs.data()+m_ndof ) continue;
+    if ( *d != iip(i)               ) continue;
+
+    i_iip.push_back(d - m_gdofs.data());
+    i_vp .push_back(vp(i));
+  }
+
+  // store
+  m_iip = ColS(i_iip.size());
+  m_vp  = ColD(i_vp .size());
+
+  for ( size_t i = 0 ; i < i_iip.size() ; ++i )
+  {
+    m_iip(i) = i_iip[i];
+    m_vp (i) = i_vp [i];
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::set_fext(const MatD &pvector)
+{
+  assert( static_cast<size_t>(pvector.rows()) == m_N    );
+  assert( static_cast<size_t>(pvector.cols()) == m_ndim );
+
+  m_fext = pvector;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD GeometryMPI::fext() const
+{
+  return m_fext;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD GeometryMPI::fres()
+{
+  // compute internal and external force
+  ColD Fint = m_vec.assembleDofs( f()    );
+  ColD Fext = m_vec.assembleDofs( m_fext );
+
+  // compute reaction forces, on the prescribed DOFs
+  for ( auto i = 0 ; i < m_iip.size() ; ++i ) Fext(m_iip(i)) = Fint(m_iip(i));
+
+  // return as particle vector
+  return m_vec.asParticle(Fext);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD GeometryMPI::solve()
+{
+  // compute internal and external force
+  ColD Fint = m_vec.assembleDofs( f()    );
+  ColD Fext = m_vec.assembleDofs( m_fext );
+
+  // solve system of equations
+  ColD A = m_Minv.cwiseProduct( Fint - Fext );
+
+  // enforce fixed displacement of boundary DOFs
+  for ( auto i = 0 ; i < m_iip.size() ; ++i ) A(m_iip(i)) = 0.0;
+
+  // return acceleration of DOFs
+  return A;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::reset()
+{
+  m_stop.reset();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool GeometryMPI::stop(double tol)
+{
+  // compute internal and external force
+  ColD Fint = m_vec.assembleDofs( f()    );
+  ColD Fext = m_vec.assembleDofs( m_fext );
+
+  // compute reaction forces, on the prescribed DOFs
+  for ( auto i = 0 ; i < m_iip.size() ; ++i ) Fext(m_iip(i)) = Fint(m_iip(i));
+
+  // compute residual force
+  ColD Res = Fint - Fext;
+
+  // sum of absolute: local contributions
+  double norm[2];
+  norm[0] = Res .cwiseAbs().sum();
+  norm[1] = Fext.cwiseAbs().sum();
+
+  // sum of absolute: sum over all processes
+  MPI_Allreduce(MPI_IN_PLACE, norm, 2, MPI_DOUBLE, MPI_SUM, m_comm);
+
+  // normalize
+  double res  = norm[0];
+  double fext = norm[1];
+
+  if ( fext != 0 ) res /= fext;
+
+  // check to stop
+  bool stop = m_stop.stop(res, tol);
+
+  // if stop: reset for next increment
+  if ( stop )
+  {
+    // - reset residuals to infinity
+    m_stop.reset();
+    // - ground system
+    m_v.setZero();
+    m_a.setZero();
+  }
+
+  return stop;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::timestep(double dt)
+{
+  // update time
+  m_t += dt;
+
+  // update periodic box (Lees-Edwards)
+  m_box.timestep(dt);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD GeometryMPI::x() const
+{
+  return m_x.topRows(m_N);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD GeometryMPI::v() const
+{
+  return m_v.topRows(m_N);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD GeometryMPI::a() const
+{
+  return m_a;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD GeometryMPI::m() const
+{
+  return m_m;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS GeometryMPI::global() const
+{
+  return m_global.head(m_N);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD GeometryMPI::f()
+{
+  // receive the position and velocity of the ghosts
+  forward(m_x);
+  forward(m_v);
+
+  // zero-initialize force vector per particle (including ghosts)
+  MatD f = MatD::Zero(m_N+m_ng, m_ndim);
+
+  // evaluate constitutive models
+  f += m_spring           .force(m_x,      m_box);
+  f += m_dashpot          .force(m_x, m_v, m_box);
+  f += m_potentialadhesion.force(m_x,      m_box);
+
+  // add the force on the ghosts to their owner
+  reverse(f);
+
+  return f.topRows(m_N);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS GeometryMPI::coordination()
+{
+  // zero-initialize coordinations column per particle (including ghosts)
+  MatD c = MatD::Zero(m_N+m_ng, 1);
+
+  // evaluate constitutive models
+  c.col(0) += m_spring           .coordination(m_x).cast<double>();
+  c.col(0) += m_dashpot          .coordination(m_x).cast<double>();
+  c.col(0) += m_potentialadhesion.coordination(m_x).cast<double>();
+
+  // add the coordination of the ghosts to their owner
+  reverse(c);
+
+  return c.col(0).head(m_N).cast<Index>();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD GeometryMPI::gather(const MatD &pvector) const
+{
+  // check input
+  assert( static_cast<size_t>(pvector.rows()) == m_N );
+
+  // number of components per particle
+  int ncol = static_cast<int>(pvector.cols());
+
+  // number of particles on each process
+  int n = static_cast<int>(m_N);
+  std::vector<int> count(m_size);
+  MPI_Allgather(&n, 1, MPI_INT, count.data(), 1, MPI_INT, m_comm);
+
+  // offsets
+  std::vector<int> ioff(m_size, 0);
+  std::vector<int> voff(m_size, 0);
+  std::vector<int> vcount(m_size);
+
+  for ( int q = 0 ; q < m_size ; ++q )
+  {
+    vcount[q] = count[q] * ncol;
+
+    if ( q == 0 ) continue;
+
+    ioff[q] = ioff[q-1] + count [q-1];
+    voff[q] = voff[q-1] + vcount[q-1];
+  }
+
+  // global particle numbers of the owned particles
+  std::vector<unsigned long long> index(m_N);
+
+  for ( size_t i = 0 ; i < m_N ; ++i )
+    index[i] = static_cast<unsigned long long>(m_global(i));
+
+  // gather all global particle numbers and values
+  std::vector<unsigned long long> iglob(m_Nglob);
+  MatD                            vglob(m_Nglob, ncol);
+
+  MatD data = pvector;
+
+  MPI_Allgatherv(index.data(), n, MPI_UNSIGNED_LONG_LONG,
+    iglob.data(), count.data(), ioff.data(), MPI_UNSIGNED_LONG_LONG, m_comm);
+
+  MPI_Allgatherv(data.data(), n*ncol, MPI_DOUBLE,
+    vglob.data(), vcount.data(), voff.data(), MPI_DOUBLE, m_comm);
+
+  // store in global particle order
+  MatD out(m_Nglob, ncol);
+
+  for ( size_t i = 0 ; i < m_Nglob ; ++i )
+    out.row(iglob[i]) = vglob.row(i);
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD GeometryMPI::dofs_v() const
+{
+  return m_vec.asDofs(MatD(m_v.topRows(m_N)));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD GeometryMPI::dofs_a() const
+{
+  return m_vec.asDofs(m_a);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD GeometryMPI::dofs_m() const
+{
+  return m_vec.asDofs(m_m);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD GeometryMPI::dofs_f()
+{
+  return m_vec.assembleDofs(f());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::set_x(const MatD &pvector)
+{
+  // check input
+  assert( static_cast<size_t>(pvector.rows()) == m_N    );
+  assert( static_cast<size_t>(pvector.cols()) == m_ndim );
+
+  // store
+  m_x.topRows(m_N) = pvector;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::set_v(const MatD &pvector)
+{
+  // check input
+  assert( static_cast<size_t>(pvector.rows()) == m_N    );
+  assert( static_cast<size_t>(pvector.cols()) == m_ndim );
+
+  // store
+  m_v.topRows(m_N) = pvector;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::set_a(const MatD &pvector)
+{
+  // check input
+  assert( static_cast<size_t>(pvector.rows()) == m_N    );
+  assert( static_cast<size_t>(pvector.cols()) == m_ndim );
+
+  // store
+  m_a = pvector;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::set_v(const ColD &Vin)
+{
+  // check input
+  assert( static_cast<size_t>(Vin.size()) == m_ndof );
+
+  // copy input
+  ColD V = Vin;
+
+  // apply boundary conditions
+  for ( auto i = 0 ; i < m_iip.size() ; ++i ) V(m_iip(i)) = m_vp(i);
+
+  // reconstruct and save nodal quantities
+  m_v.topRows(m_N) = m_vec.asParticle(V);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void GeometryMPI::set_a(const ColD &Ain)
+{
+  // check input
+  assert( static_cast<size_t>(Ain.size()) == m_ndof );
+
+  // copy input
+  ColD A = Ain;
+
+  // apply boundary conditions
+  for ( auto i = 0 ; i < m_iip.size() ; ++i ) A(m_iip(i)) = 0.0;
+
+  // reconstruct and save nodal quantities
+  m_a = m_vec.asParticle(A);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS partition(const MatD &x, size_t nproc)
+{
+  // dimensions
+  size_t N    = static_cast<size_t>(x.rows());
+  size_t ndim = static_cast<size_t>(x.cols());
+
+  // allocate partition
+  ColS part(N);
+
+  // particle numbers, that are reordered such that each process owns a contiguous range
+  std::vector<size_t> index(N);
+  std::iota(index.begin(), index.end(), 0);
+
+  // ranges that still have to be bisected: {begin, end, first process, number of processes}
+  std::vector<std::array<size_t,4>> todo;
+  todo.push_back({0, N, 0, nproc});
+
+  while ( todo.size() > 0 )
+  {
+    // - extract range
+    auto range = todo.back();
+    todo.pop_back();
+
+    size_t begin = range[0];
+    size_t end   = range[1];
+    size_t first = range[2];
+    size_t np    = range[3];
+
+    // - single process: store
+    if ( np == 1 )
+    {
+      for ( size_t n = begin ; n < end ; ++n ) part(index[n]) = first;
+      continue;
+    }
+
+    // - find the direction in which the particles are most spread
+    ColD lo = ColD::Constant(ndim,  std::numeric_limits<double>::infinity());
+    ColD hi = ColD::Constant(ndim, -std::numeric_limits<double>::infinity());
+
+    for ( size_t n = begin ; n < end ; ++n )
+    {
+      for ( size_t i = 0 ; i < ndim ; ++i )
+      {
+        lo(i) = std::min(lo(i), x(index[n],i));
+        hi(i) = std::max(hi(i), x(index[n],i));
+      }
+    }
+
+    size_t dir;
+    (hi - lo).maxCoeff(&dir);
+
+    // - bisect, proportional to the number of processes on each side
+    size_t nleft = np / 2;
+    size_t mid   = begin + ( (end - begin) * nleft ) / np;
+
+    std::nth_element(index.begin()+begin, index.begin()+mid, index.begin()+end,
+      [&x, dir](size_t i, size_t j){ return x(i,dir) < x(j,dir); });
+
+    todo.push_back({begin, mid, first      , nleft   });
+    todo.push_back({mid  , end, first+nleft, np-nleft});
+  }
+
+  return part;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+}}} // namespace ...
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,204 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_EXT_FRICITION_GEOMETYMPI_H
+#define GOOSEDEM_EXT_FRICITION_GEOMETYMPI_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include <mpi.h>
+#include <array>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "Friction.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+namespace Ext {
+namespace Friction {
+
+// -------------------------------------------------------------------------------------------------
+
+// Domain decomposed variant of "Geometry". Each process owns a set of particles, and evaluates the
+// interactions of which the first particle is owned. The other particle of such an interaction is
+// a "ghost" if it is owned by another process: before each force evaluation the position and
+// velocity of the ghosts is received from their owner, after it the force on the ghosts is sent
+// back to the owner. All particle vectors and DOF values are local: they refer only to the owned
+// particles (in increasing global particle number), and to the DOFs of these particles. Particles
+// that share a DOF have to be owned by the same process.
+//
+// Each process is given only its own part of the system: the constructor takes the owned
+// particles, "set" takes (at least) the owned interactions, in global particle numbers. No process
+// stores data of the size of the global system: the owner of each particle is found through a
+// directory that is distributed over the processes (particle "i" is registered on process
+// "i % size"). All functions are collective. Integrators that take decisions based on the particle
+// vectors (such as "adaptiveVelocityVerlet") would decide per process, and can therefore not be
+// used. Likewise the breaking criteria of the constitutive models are not evaluated.
+
+class GeometryMPI : public GooseDEM::Geometry
+{
+private:
+
+  // communicator
+  MPI_Comm m_comm;
+  int      m_rank;
+  int      m_size;
+
+  // conversion vector
+  Vector m_vec;
+
+  // partition
+  ColS                               m_global;    // global number per local particle [N+ng]
+  std::unordered_map<size_t, size_t> m_local;     // local number per global particle
+  std::unordered_map<size_t, int>    m_directory; // owner of the particles registered here
+
+  // halo exchange: per process the local particle numbers to send/receive (in the same order on
+  // the sending and the receiving process)
+  std::vector<std::vector<size_t>> m_send;
+  std::vector<std::vector<size_t>> m_recv;
+
+  // particles (position and velocity also store the ghosts)
+  MatD m_fext;   // external force [N, ndim]
+  MatD m_x;      // position       [N+ng, ndim]
+  MatD m_v;      // velocity       [N+ng, ndim]
+  MatD m_a;      // acceleration   [N, ndim]
+  ColD m_m;      // mass           [N]
+  MatS m_dofs;   // DOF-number     [N, ndim]
+
+  // global DOF-numbers of the local DOFs [ndof]
+  ColS m_gdofs;
+
+  // prescribed DOFs
+  ColS m_iip;    // DOF-numbers         [np]
+  ColD m_vp;     // prescribed velocity [np]
+
+  // DOF values
+  ColD m_M;      // mass            [ndof]
+  ColD m_Minv;   // inverse of mass [ndof]
+
+  // periodic box
+  Periodic m_box;
+
+  // time & convergence check
+  double   m_t;
+  StopList m_stop;
+
+  // dimensions
+  size_t m_Nglob; // total number of particles
+  size_t m_N;     // number of owned particles
+  size_t m_ng;    // number of ghost particles
+  size_t m_ndim;  // number of spatial dimensions
+  size_t m_ndof;  // number of local DOFs
+
+  // constitutive models (in local particle numbers)
+  Spring            m_spring;
+  Dashpot           m_dashpot;
+  PotentialAdhesion m_potentialadhesion;
+
+public:
+
+  // constructor: the owned particles, their mass [N], position [N, ndim], global DOF-numbers
+  // [N, ndim], and global particle numbers [N] (increasing; all processes together number the
+  // particles "0 .. Nglob-1")
+  GeometryMPI(MPI_Comm comm, const ColD &m, const MatD &x, const MatS &dofs, const ColS &global);
+
+  // set constitutive models, in global particle numbers: the interactions of which the first
+  // particle is not owned are ignored (the model can contain only the owned interactions)
+  void set(const Spring            &mat);
+  void set(const Dashpot           &mat);
+  void set(const PotentialAdhesion &mat);
+
+  // set periodic box (used by all constitutive models)
+  void set(const Periodic &box);
+
+  // set fixed velocity (global DOF-numbers, entries of other processes are ignored)
+  void fix_v(const ColS &iip, const ColD &vp);
+
+  // set external force [N, ndim]
+  void set_fext(const MatD &pvector);
+
+  // return set external or reaction force force [N, ndim]
+  MatD fext() const;
+  MatD fres();
+
+  // solve for DOF-accelerations [ndof]
+  ColD solve() override;
+
+  // reset residuals, check for convergence (same result on all processes)
+  void reset() override;
+  bool stop(double tol) override;
+
+  // process time-step
+  void timestep(double dt) override;
+
+  // return particle vectors [N, ndim]
+  MatD x()            const override;
+  MatD v()            const override;
+  MatD a()            const override;
+  MatD f();
+  ColS coordination();
+  ColD m()            const;
+
+  // return the global particle number of the owned particles [N]
+  ColS global() const;
+
+  // gather a particle vector [N, ndim] of all processes [Nglob, ndim] (on all processes)
+  MatD gather(const MatD &pvector) const;
+
+  // return DOF values [ndof]
+  ColD dofs_v() const override;
+  ColD dofs_a() const override;
+  ColD dofs_f();
+  ColD dofs_m() const override;
+
+  // overwrite particle vectors [N, ndim]
+  void set_x(const MatD &pvector) override;
+  void set_v(const MatD &pvector);
+  void set_a(const MatD &pvector);
+
+  // overwrite particle vectors, reconstructed from DOF values
+  void set_v(const ColD &dofval) override; // == set_v(asParticle(V))
+  void set_a(const ColD &dofval) override; // == set_a(asParticle(A))
+
+private:
+
+  // add ghosts for the interactions owned by this process, and update the halo exchange plan;
+  // return the interactions owned by this process
+  ColS ghosts(const MatS &particles);
+
+  // send a list of numbers to each process, return the list received from each process
+  std::vector<std::vector<size_t>> alltoall(const std::vector<std::vector<size_t>> &send) const;
+
+  // throw (on all processes) if "error" is true on any process
+  void check(bool error, const char *message) const;
+
+  // return the particles in local numbering
+  MatS renumber(const MatS &particles, const ColS &index) const;
+
+  // halo exchange: copy the owned rows to the ghosts on other processes (forward), add the ghost
+  // rows to the owned rows on other processes (reverse)
+  void forward(MatD &pvector) const;
+  void reverse(MatD &pvector) const;
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+// partition the particles over "nproc" processes, using recursive coordinate bisection
+inline ColS partition(const MatD &x, size_t nproc);
+
+// -------------------------------------------------------------------------------------------------
+
+}}} // namespace ...
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
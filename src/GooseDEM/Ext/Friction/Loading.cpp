@@ -0,0 +1,252 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_EXT_FRICTION_LOADING_CPP
+#define GOOSEDEM_EXT_FRICTION_LOADING_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "Loading.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+namespace Ext {
+namespace Friction {
+
+// ------------------------------------------ constructor ------------------------------------------
+
+inline Loading::Loading(Geometry &geometry, double dt, const Convergence &convergence,
+  Predictor predictor) :
+  m_geometry(geometry), m_dt(dt), m_convergence(convergence), m_predictor(predictor),
+  m_np(0)
+{
+  m_x_n    = m_geometry.x();
+  m_fext_n = m_geometry.fext();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Loading::increment(const MatD &fext, const ColD &up, const MatD &F)
+{
+  // last equilibrium, prescribed DOFs (set by "fix_v", without the vacant slots), DOF-numbers
+  MatD  X    = m_geometry.x();
+  ColS  iip  = m_geometry.iip_fixed();
+  const MatS &dofs = *m_geometry.view_dofs();
+
+  // new particle slots
+  if ( m_fext_n.rows() < X.rows() ) grow(X);
+
+  // check input
+  assert( fext.rows() == X.rows() );
+  assert( fext.cols() == X.cols() );
+  assert( up.size() == 0 || up.size() == iip.size() );
+
+  // index of each DOF in the list of prescribed DOFs (-1 if free)
+  std::vector<int64_t> ip(static_cast<size_t>(dofs.maxCoeff()+1), -1);
+
+  for ( auto i = 0 ; i < iip.size() ; ++i ) ip[iip(i)] = i;
+
+  // load increment
+  MatD dfext = fext - m_fext_n;
+
+  // predict the displacement of the free DOFs
+  MatD dX = MatD::Zero(X.rows(), X.cols());
+
+  if ( m_predictor == Predictor::affine && F.size() > 0 )
+  {
+    assert( F.rows() == X.cols() );
+    assert( F.cols() == X.cols() );
+
+    dX = X * ( F - MatD::Identity(F.rows(), F.cols()) ).transpose();
+  }
+  else if ( m_predictor == Predictor::secant && m_x_nm1.size() > 0 )
+  {
+    dX = secant(dfext, up) * ( m_x_n - m_x_nm1 );
+  }
+
+  // displace the prescribed DOFs
+  for ( auto k = 0 ; k < dofs.size() ; ++k )
+  {
+    int64_t i = ip[dofs.data()[k]];
+
+    if ( i >= 0 ) dX.data()[k] = up.size() > 0 ? up(i) : 0.0;
+  }
+
+  // apply the load and the prediction, from rest
+  m_geometry.set_fext(fext);
+  m_geometry.set_x(MatD( X + dX ));
+  m_geometry.set_v(ColD( ColD::Zero(m_geometry.dofs_v().size()) ));
+  m_geometry.set_a(ColD( ColD::Zero(m_geometry.dofs_a().size()) ));
+
+  // relax
+  size_t iiter = quasiStaticVelocityVerlet(m_geometry, m_dt, m_convergence);
+
+  // record: number of iterations, reaction force on the prescribed DOFs
+  MatD fres = m_geometry.fres();
+
+  if ( m_iter.size() == 0 ) m_np = static_cast<size_t>(iip.size());
+
+  if ( static_cast<size_t>(iip.size()) != m_np )
+    throw std::runtime_error("GooseDEM::Ext::Friction::Loading: number of prescribed DOFs changed");
+
+  ColD R = ColD::Zero(iip.size());
+
+  for ( auto k = 0 ; k < dofs.size() ; ++k )
+  {
+    int64_t i = ip[dofs.data()[k]];
+
+    if ( i >= 0 ) R(i) = fres.data()[k];
+  }
+
+  m_iter.push_back(iiter);
+  m_reaction.insert(m_reaction.end(), R.data(), R.data()+R.size());
+
+  // update the history
+  m_x_nm1   = X;
+  m_x_n     = m_geometry.x();
+  m_fext_n  = fext;
+  m_dfext_n = dfext;
+  m_up_n    = up;
+
+  return iiter;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Loading::grow(const MatD &X)
+{
+  // number of particles in the history
+  auto n = m_fext_n.rows();
+  auto m = X.rows() - n;
+
+  // no load on the new slots
+  m_fext_n.conservativeResize(X.rows(), X.cols());
+  m_fext_n.bottomRows(m).setZero();
+
+  if ( m_dfext_n.size() > 0 )
+  {
+    m_dfext_n.conservativeResize(X.rows(), X.cols());
+    m_dfext_n.bottomRows(m).setZero();
+  }
+
+  // no displacement of the new slots
+  m_x_n.conservativeResize(X.rows(), X.cols());
+  m_x_n.bottomRows(m) = X.bottomRows(m);
+
+  if ( m_x_nm1.size() > 0 )
+  {
+    m_x_nm1.conservativeResize(X.rows(), X.cols());
+    m_x_nm1.bottomRows(m) = X.bottomRows(m);
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Loading::renumber(const ColS &index)
+{
+  // slots that were added since the last increment have moved already: restart the history
+  if ( m_fext_n.rows() != index.size() ) return reset();
+
+  // move the rows with the particles
+  auto permute = [&index](MatD &data)
+  {
+    if ( data.size() == 0 ) return;
+
+    MatD copy = data;
+
+    for ( auto i = 0 ; i < index.size() ; ++i ) data.row(i) = copy.row(index(i));
+  };
+
+  permute(m_x_n);
+  permute(m_x_nm1);
+  permute(m_fext_n);
+  permute(m_dfext_n);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Loading::reset()
+{
+  m_x_n    = m_geometry.x();
+  m_fext_n = m_geometry.fext();
+
+  m_x_nm1  .resize(0, 0);
+  m_dfext_n.resize(0, 0);
+  m_up_n   .resize(0);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline double Loading::secant(const MatD &dfext, const ColD &up) const
+{
+  // sum of the ratios, and their number
+  double ratio = 0.0;
+  size_t n     = 0;
+
+  // external force: projection on the last increment (zero if there was none)
+  double ff = m_dfext_n.squaredNorm();
+
+  if ( ff > 0.0 )
+  {
+    ratio += ( dfext.array() * m_dfext_n.array() ).sum() / ff;
+    n     += 1;
+  }
+
+  // prescribed displacement: projection on the last increment (zero if there was none)
+  double uu = m_up_n.squaredNorm();
+
+  if ( uu > 0.0 )
+  {
+    if ( up.size() == m_up_n.size() ) ratio += up.dot(m_up_n) / uu;
+    n += 1;
+  }
+
+  if ( n == 0 ) return 0.0;
+
+  return ratio / static_cast<double>(n);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Loading::run(const std::vector<MatD> &fext)
+{
+  ColS iter(fext.size());
+
+  for ( size_t i = 0 ; i < fext.size() ; ++i ) iter(i) = increment(fext[i]);
+
+  return iter;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Loading::size() const
+{
+  return m_iter.size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Loading::iterations() const
+{
+  return Eigen::Map<const Eigen::Matrix<size_t,Eigen::Dynamic,1>>(m_iter.data(), m_iter.size())
+    .cast<Index>();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Loading::reaction() const
+{
+  return Eigen::Map<const MatD>(m_reaction.data(), m_iter.size(), m_np);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+}}} // namespace ...
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
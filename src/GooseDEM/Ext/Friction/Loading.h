@@ -0,0 +1,115 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_EXT_FRICTION_LOADING_H
+#define GOOSEDEM_EXT_FRICTION_LOADING_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include "Friction.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+namespace Ext {
+namespace Friction {
+
+// -------------------------------------------------------------------------------------------------
+
+// predictor of the displacement field at the start of a load increment
+enum class Predictor
+{
+  none,   // start from the previous equilibrium
+  affine, // apply the affine deformation of the increment to all particles
+  secant  // extrapolate the displacement of the previous increment, scaled by the load increment
+          // relative to the previous load increment (signed: reversed when unloading)
+};
+
+// -------------------------------------------------------------------------------------------------
+
+// Quasi-static load stepping: each increment sets the external force and displaces the prescribed
+// DOFs, predicts the displacement of the free DOFs, and relaxes using "quasiStaticVelocityVerlet"
+// with the given convergence check. The prescribed DOFs are displaced directly (their velocity
+// should be zero, see "Geometry::fix_v"). The secant predictor extrapolates the displacement
+// between the last two equilibria, scaled by the projection of the load increment on the last load
+// increment (the mean of the ratio for the external force and that for the prescribed
+// displacement, each relative to its own last increment). The number of iterations and the
+// reaction force on the prescribed DOFs (see "Geometry::fres") are recorded for each increment.
+// The history is stored per particle slot: after "Geometry::compact" it has to be renumbered (with
+// the returned mapping), after "Geometry::remove" it has to be reset before a slot is reused.
+
+class Loading
+{
+private:
+
+  // geometry, time step, convergence check, predictor
+  Geometry   &m_geometry;
+  double      m_dt;
+  Convergence m_convergence;
+  Predictor   m_predictor;
+
+  // last two equilibria [N, ndim], the last external force [N, ndim], and the last load
+  // increment: external force [N, ndim] and prescribed displacement [np] (empty if there is none)
+  MatD m_x_n;
+  MatD m_x_nm1;
+  MatD m_fext_n;
+  MatD m_dfext_n;
+  ColD m_up_n;
+
+  // records: number of iterations [nincrement], reaction forces [nincrement, np] (row-major)
+  std::vector<size_t> m_iter;
+  std::vector<double> m_reaction;
+  size_t              m_np;
+
+public:
+
+  // constructor (the geometry is used by reference, and must be kept alive)
+  Loading(Geometry &geometry, double dt, const Convergence &convergence,
+    Predictor predictor=Predictor::secant);
+
+  // apply a load increment: the external force [N, ndim], the displacement of the prescribed DOFs
+  // [np] (see "Geometry::iip_fixed") (w.r.t. the last equilibrium, default: none), and the affine
+  // deformation gradient of the increment [ndim, ndim] (only used by the "affine" predictor,
+  // default: none); relax, return the number of iterations
+  size_t increment(const MatD &fext, const ColD &up=ColD(), const MatD &F=MatD());
+
+  // apply a load path of external forces (one increment per item), return the number of
+  // iterations of each increment
+  ColS run(const std::vector<MatD> &fext);
+
+  // renumber the history after "Geometry::compact", given the former number of each slot [N]
+  // (the history is reset if slots were added since the last increment)
+  void renumber(const ColS &index);
+
+  // restart the history from the current state of the geometry (the next increment has no secant
+  // prediction), e.g. after particles are removed or inserted
+  void reset();
+
+  // return the number of increments, the number of iterations of each increment [nincrement], and
+  // the reaction force on the prescribed DOFs of each increment [nincrement, np]
+  size_t size()       const;
+  ColS   iterations() const;
+  MatD   reaction()   const;
+
+private:
+
+  // extend the history with the particle slots that were added since the last increment (e.g. by
+  // "Geometry::insert" or "Geometry::reserve"): no load, and no displacement
+  void grow(const MatD &x);
+
+  // scale factor of the secant predictor for a load increment: external force [N, ndim] and
+  // prescribed displacement [np]
+  double secant(const MatD &dfext, const ColD &up) const;
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+}}} // namespace ...
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
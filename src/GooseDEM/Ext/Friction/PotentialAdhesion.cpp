@@ -25,59 +25,153 @@ namespace Friction {
 
 // -------------------------------------------------------------------------------------------------
 
+inline PotentialAdhesion::PotentialAdhesion() :
+  PotentialAdhesion(std::make_shared<const Topology>(), ColD(), ColD(), ColD(), ColD())
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline PotentialAdhesion::PotentialAdhesion(
+  MatS particles, ColD k, ColD b, ColD r0, ColD e) :
+  PotentialAdhesion(std::make_shared<const Topology>(std::move(particles)),
+    std::move(k), std::move(b), std::move(r0), std::move(e))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline PotentialAdhesion::PotentialAdhesion(std::shared_ptr<const Topology> topology,
+  ColD k, ColD b, ColD r0, ColD e) :
+  PotentialAdhesion(PairState(std::move(topology)), std::move(k), std::move(b), std::move(r0),
+    std::move(e))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
 inline PotentialAdhesion::PotentialAdhesion(
-  const MatS &particles, const ColD &k, const ColD &b, const ColD &r0, const ColD &e) :
-  m_particles(particles), m_k(k), m_b(b), m_r0(r0), m_e(e)
+  MatS particles, ColT type, ColD k, ColD b, ColD r0, ColD e) :
+  PotentialAdhesion(std::make_shared<const Topology>(std::move(particles)), std::move(type),
+    std::move(k), std::move(b), std::move(r0), std::move(e))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline PotentialAdhesion::PotentialAdhesion(std::shared_ptr<const Topology> topology,
+  ColT type, ColD k, ColD b, ColD r0, ColD e) :
+  PotentialAdhesion(PairState(std::move(topology), std::move(type)), std::move(k), std::move(b),
+    std::move(r0), std::move(e))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline PotentialAdhesion::PotentialAdhesion(PairState state, ColD k, ColD b, ColD r0, ColD e) :
+  m_state(std::move(state)), m_k(std::move(k)), m_b(std::move(b)),
+  m_r0(std::move(r0)), m_e(std::move(e))
 {
   // check input
-  assert( m_particles.rows() == m_k .size() );
-  assert( m_particles.rows() == m_b .size() );
-  assert( m_particles.rows() == m_r0.size() );
-  assert( m_particles.rows() == m_e .size() );
+  assert( m_state.check(m_k.size()) );
+  assert( m_k.size() == m_b.size() );
+  assert( m_k.size() == m_r0.size() );
+  assert( m_k.size() == m_e.size() );
+
+  // precompute the derived constants per type
+  if ( m_state.typed() )
+    for ( auto t = 0 ; t < m_k.size() ; ++t )
+      m_table.push_back(constants(m_k(t), m_b(t), m_r0(t), m_e(t)));
+
+  // unbreakable
+  m_D_c = ColD::Constant(m_state.size(), std::numeric_limits<double>::infinity());
+  m_rupture = false;
 }
 
 // -------------------------------------------------------------------------------------------------
 
 inline MatD PotentialAdhesion::force(const MatD &X) const
 {
-  // dimensions
-  auto n    = X.rows(); // number of particles
-  auto ndim = X.cols(); // number of dimensions
+  return force(X, Periodic());
+}
 
+// -------------------------------------------------------------------------------------------------
+
+inline MatD PotentialAdhesion::force(const MatD &X, const Periodic &box) const
+{
   // zero-initialize force per particle
-  MatD F = MatD::Zero(n, ndim);
+  MatD F = MatD::Zero(X.rows(), X.cols());
+
+  // all interacting particle pairs
+  add_force(X, box, m_state.size(), [](size_t k){ return k; }, F);
+
+  return F;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void PotentialAdhesion::force(const MatD &X, const Periodic &box, const Index *index,
+  size_t m, MatD &F) const
+{
+  // check input
+  assert( F.rows() == X.rows() );
+  assert( F.cols() == X.cols() );
+
+  add_force(X, box, m, [index](size_t k){ return index[k]; }, F);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <class P>
+inline void PotentialAdhesion::add_force(const MatD &X, const Periodic &box, size_t m, P pair,
+  MatD &F) const
+{
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // number of dimensions
+  auto ndim = X.cols();
 
   // local variables
   cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
   cppmat::cartesian::vector<double> xj(ndim); // position of particle "j"
   cppmat::cartesian::vector<double> dx(ndim); // position difference
   cppmat::cartesian::vector<double> f (ndim); // force vector
-  double D; // distance in 'local coordinates'
+  double D;  // distance in 'local coordinates'
+  double s6; // "(r0 / D)^6"
+  double u;  // distance w.r.t. the equilibrium length
 
-  // loop over all interacting particle pairs
-  for ( auto p = 0 ; p < m_particles.rows() ; ++p )
+  // loop over the interacting particle pairs
+  for ( size_t k = 0 ; k < m ; ++k )
   {
+    // - pair number, skip broken pairs
+    auto p = pair(k);
+    if ( ! m_state.active(p) ) continue;
     // - extract particle numbers
-    auto i = m_particles(p,0);
-    auto j = m_particles(p,1);
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
     // - copy the particles' positions to the vectors "xi" and "xj"
     std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
     std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
     // - compute the position difference vector
     dx = xj - xi;
+    // - apply periodicity
+    box.minimumImage(dx.data());
     // - compute the current length
     D = dx.length();
     // - compute the force vector, by comparing to the interacted particles' initial length
+    const Constants c = constants(p);
     // -- Lennard-Jones force
-    if ( D <= m_r0(p) )
+    if ( D <= c.r0 )
     {
-      f = 12 * m_e(p) / D * ( std::pow( m_r0(p) / D, 6 ) - std::pow( m_r0(p) / D, 12 ) ) * dx/D;
+      s6 = c.r06 / (D*D * D*D * D*D);
+      f  = c.e12 / D * ( s6 - s6*s6 ) * dx/D;
     }
     // -- Innovative force
     else
     {
-      f = (std::pow( m_k(p), 2 ) * m_b(p) * (std::pow( D - m_r0(p), 2) ) \
-        + 2 * m_k(p) * (D - m_r0(p))) * exp(- m_k(p) * m_b(p) * (D - m_r0(p))) * dx/D;
+      u = D - c.r0;
+      f = ( c.k2b * u*u + 2 * c.k * u ) * std::exp( - c.kb * u ) * dx/D;
     }
 
     // - assemble the force to the particles
@@ -87,79 +181,492 @@ inline MatD PotentialAdhesion::force(const MatD &X) const
       F(j,d) -= f(d);
     }
   }
-
-  return F;
 }
 
 // -------------------------------------------------------------------------------------------------
 
 inline ColS PotentialAdhesion::coordination(const MatD &X) const
 {
-  // zero-initialize coordination per particle
-  ColS C = ColS::Zero(X.rows());
+  return m_state.coordination(X.rows());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD PotentialAdhesion::potential(const MatD &X) const
+{
+  return potential(X, Periodic());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD PotentialAdhesion::potential(const MatD &X, const Periodic &box) const
+{
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // dimensions
+  auto ndim = X.cols(); // number of dimensions
+
+  // zero-initialize energy per interacted pair
+  ColD V = ColD::Zero(pairs.rows());
+
+  // local variables
+  cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
+  cppmat::cartesian::vector<double> xj(ndim); // position of particle "j"
+  cppmat::cartesian::vector<double> dx(ndim); // position difference
+  double D;  // distance in 'local coordinates'
+  double s6; // "(r0 / D)^6"
+  double u;  // distance w.r.t. the equilibrium length
+
+  // loop over all interacted particle pairs
+  for ( auto p = 0 ; p < pairs.rows() ; ++p )
+  {
+    // - skip broken pairs
+    if ( ! m_state.active(p) ) continue;
+    // - extract particle numbers
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
+    // - copy the particles' positions to the vectors "xi" and "xj"
+    std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
+    std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
+    // - compute the position difference vector
+    dx = xj - xi;
+    // - apply periodicity
+    box.minimumImage(dx.data());
+    // - compute the current length
+    D = dx.length();
+    // - compute the energy, by comparing to the interacted particles' initial length
+    const Constants c = constants(p);
+    // -- Lennard-Jones
+    if ( D <= c.r0 )
+    {
+      s6   = c.r06 / (D*D * D*D * D*D);
+      V(p) = c.e * ( s6*s6 - 2 * s6 );
+    }
+    // -- innovative
+    else
+    {
+      u    = D - c.r0;
+      V(p) = - c.k * std::pow( u + c.c2, 2 ) * std::exp( - c.kb * u ) + c.V0;
+    }
+  }
+
+  return V;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD PotentialAdhesion::stiffness(const MatD &X, const Periodic &box) const
+{
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // dimensions
+  auto ndim = X.cols(); // number of dimensions
+
+  // zero-initialize stiffness per interacted pair
+  ColD K = ColD::Zero(pairs.rows());
+
+  // local variables
+  cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
+  cppmat::cartesian::vector<double> xj(ndim); // position of particle "j"
+  cppmat::cartesian::vector<double> dx(ndim); // position difference
+  double D;  // distance in 'local coordinates'
+  double f;  // magnitude of the force
+  double df; // derivative of the magnitude of the force w.r.t. the distance
+  double s6; // "(r0 / D)^6"
+  double u;  // distance w.r.t. the equilibrium length
+  double ex; // exponential decay
 
   // loop over all interacted particle pairs
-  for ( auto p = 0 ; p < m_particles.rows() ; ++p )
+  for ( auto p = 0 ; p < pairs.rows() ; ++p )
   {
+    // - skip broken pairs
+    if ( ! m_state.active(p) ) continue;
     // - extract particle numbers
-    auto i = m_particles(p,0);
-    auto j = m_particles(p,1);
-    // - add to coordination
-    C(i) += 1;
-    C(j) += 1;
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
+    // - copy the particles' positions to the vectors "xi" and "xj"
+    std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
+    std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
+    // - compute the position difference vector
+    dx = xj - xi;
+    // - apply periodicity
+    box.minimumImage(dx.data());
+    // - compute the current length
+    D = dx.length();
+    // - compute the magnitude of the force and its derivative
+    const Constants c = constants(p);
+    // -- Lennard-Jones
+    if ( D <= c.r0 )
+    {
+      s6 = c.r06 / (D*D * D*D * D*D);
+      f  =   c.e12 / D     * (     s6 -      s6*s6 );
+      df = - c.e12 / (D*D) * ( 7 * s6 - 13 * s6*s6 );
+    }
+    // -- innovative
+    else
+    {
+      u  = D - c.r0;
+      ex = std::exp( - c.kb * u );
+      f  = ( c.k2b * u*u + 2 * c.k * u ) * ex;
+      df = c.k * ( 2 - std::pow( c.kb * u, 2 ) ) * ex;
+    }
+    // - largest of the axial stiffness and the geometric (transverse) stiffness
+    K(p) = std::max(std::abs(df), std::abs(f / D));
   }
 
-  return C;
+  return K;
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline ColD PotentialAdhesion::potential(const MatD &X) const
+inline MatD PotentialAdhesion::tangent(const MatD &X, const Periodic &box) const
 {
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
   // dimensions
-  auto n    = X.rows(); // number of particles
   auto ndim = X.cols(); // number of dimensions
 
-  // zero-initialize force per particle
-  ColD V = ColD::Zero(n);
+  // zero-initialize tangent per interacted pair
+  MatD K = MatD::Zero(pairs.rows(), ndim*ndim);
 
   // local variables
   cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
   cppmat::cartesian::vector<double> xj(ndim); // position of particle "j"
   cppmat::cartesian::vector<double> dx(ndim); // position difference
-  double D; // distance in 'local coordinates'
+  double D;  // distance in 'local coordinates'
+  double ka; // axial stiffness: derivative of the magnitude of the force w.r.t. the distance
+  double kt; // geometric (transverse) stiffness: magnitude of the force divided by the distance
+  double s6; // "(r0 / D)^6"
+  double u;  // distance w.r.t. the equilibrium length
+  double ex; // exponential decay
 
   // loop over all interacted particle pairs
-  for ( auto p = 0 ; p < m_particles.rows() ; ++p )
+  for ( auto p = 0 ; p < pairs.rows() ; ++p )
   {
+    // - skip broken pairs
+    if ( ! m_state.active(p) ) continue;
     // - extract particle numbers
-    auto i = m_particles(p,0);
-    auto j = m_particles(p,1);
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
     // - copy the particles' positions to the vectors "xi" and "xj"
     std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
     std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
     // - compute the position difference vector
     dx = xj - xi;
+    // - apply periodicity
+    box.minimumImage(dx.data());
     // - compute the current length
     D = dx.length();
-    // - compute the force vector, by comparing to the interacted particles' initial length
+    // - compute the axial and geometric stiffness
+    const Constants c = constants(p);
     // -- Lennard-Jones
-    if ( D <= m_r0(p) )
+    if ( D <= c.r0 )
     {
-      V(p) = m_e(p) * ( std::pow( m_r0(p) / D, 12 ) - 2 * std::pow( m_r0(p) / D, 6 ) );
+      s6 = c.r06 / (D*D * D*D * D*D);
+      kt =   c.e12 / (D*D) * (     s6 -      s6*s6 );
+      ka = - c.e12 / (D*D) * ( 7 * s6 - 13 * s6*s6 );
     }
     // -- innovative
     else
     {
-      V(p) = - m_k(p) * std::pow( D - m_r0(p) \
-           + 2 / (m_k(p) * m_b(p)), 2 ) * exp( - m_k(p) * m_b(p) * (D - m_r0(p)) ) \
-           + 4 / (m_k(p) * pow(m_b(p), 2)) - m_e(p);
+      u  = D - c.r0;
+      ex = std::exp( - c.kb * u );
+      kt = ( c.k2b * u*u + 2 * c.k * u ) * ex / D;
+      ka = c.k * ( 2 - std::pow( c.kb * u, 2 ) ) * ex;
+    }
+    // - tangent: ka * n n + kt * (I - n n), with "n = dx/D"
+    for ( auto a = 0 ; a < ndim ; ++a )
+    {
+      for ( auto b = 0 ; b < ndim ; ++b )
+      {
+        K(p,a*ndim+b) = (ka - kt) * dx(a) * dx(b) / (D*D);
+        if ( a == b ) K(p,a*ndim+b) += kt;
+      }
     }
   }
 
-  return V;
+  return K;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void PotentialAdhesion::deactivate(const ColS &index)
+{
+  m_state.deactivate(index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColB& PotentialAdhesion::active() const
+{
+  return m_state.active();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t PotentialAdhesion::ndead() const
+{
+  return m_state.ndead();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS PotentialAdhesion::compact()
+{
+  // nothing to do
+  if ( m_state.ndead() == 0 ) return m_state.compact();
+
+  // remove the broken pairs, keep the parameters of the remaining pairs
+  ColS index = m_state.compact();
+
+  compact_param(index);
+
+  return index;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void PotentialAdhesion::compact(std::shared_ptr<const Topology> topology, const ColS &index)
+{
+  m_state.compact(std::move(topology), index);
+
+  compact_param(index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void PotentialAdhesion::set_rupture(const ColD &D_c)
+{
+  // check input
+  assert( static_cast<Eigen::Index>(m_state.size()) == D_c.size() );
+
+  // store
+  m_D_c = D_c;
+
+  // enable the check only if some pairs can break
+  m_rupture = ( D_c.array() < std::numeric_limits<double>::infinity() ).any();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS PotentialAdhesion::rupture(const MatD &X, const Periodic &box)
+{
+  // no pairs can break
+  if ( ! m_rupture ) return ColS();
+
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // dimensions
+  auto ndim = X.cols(); // number of dimensions
+
+  // list of pairs that break
+  ColS   broken(pairs.rows());
+  size_t nbroken = 0;
+
+  // local variables
+  cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
+  cppmat::cartesian::vector<double> xj(ndim); // position of particle "j"
+  cppmat::cartesian::vector<double> dx(ndim); // position difference
+  double D;                                   // distance in 'local coordinates'
+
+  // loop over all interacted pairs
+  for ( auto p = 0 ; p < pairs.rows() ; ++p )
+  {
+    // - skip broken pairs
+    if ( ! m_state.active(p) ) continue;
+    // - extract particle numbers
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
+    // - copy the particles' positions to the vectors "xi" and "xj"
+    std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
+    std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
+    // - compute the position difference vector
+    dx = xj - xi;
+    // - apply periodicity
+    box.minimumImage(dx.data());
+    // - compute the current length
+    D = dx.length();
+    // - check the critical distance
+    if ( D > m_D_c(p) ) broken(nbroken++) = p;
+  }
+
+  // deactivate
+  broken.conservativeResize(nbroken);
+
+  deactivate(broken);
+
+  return broken;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD PotentialAdhesion::D_c() const
+{
+  return m_D_c;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::shared_ptr<const Topology> PotentialAdhesion::topology() const
+{
+  return m_state.topology();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const MatS& PotentialAdhesion::particles() const
+{
+  return m_state.particles();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD PotentialAdhesion::k() const
+{
+  return m_state.expand(m_k);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD PotentialAdhesion::b() const
+{
+  return m_state.expand(m_b);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD PotentialAdhesion::r0() const
+{
+  return m_state.expand(m_r0);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD PotentialAdhesion::e() const
+{
+  return m_state.expand(m_e);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColT PotentialAdhesion::type() const
+{
+  return m_state.type();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t PotentialAdhesion::ntype() const
+{
+  return m_table.size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline PotentialAdhesion::Constants PotentialAdhesion::constants(size_t p) const
+{
+  if ( m_state.typed() ) return m_table[m_state.param(p)];
+
+  return constants(m_k(p), m_b(p), m_r0(p), m_e(p));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline PotentialAdhesion::Constants PotentialAdhesion::constants(
+  double k, double b, double r0, double e)
+{
+  Constants c;
+
+  c.k   = k;
+  c.r0  = r0;
+  c.e   = e;
+  c.e12 = 12 * e;
+  c.r06 = std::pow( r0, 6 );
+  c.kb  = k * b;
+  c.k2b = k * k * b;
+  c.c2  = 2 / (k * b);
+  c.V0  = 4 / (k * b * b) - e;
+
+  return c;
 }
 
+// -------------------------------------------------------------------------------------------------
+
+inline void PotentialAdhesion::append(const MatS &particles, const ColD &k, const ColD &b,
+  const ColD &r0, const ColD &e, const ColD &D_c)
+{
+  // check input
+  assert( ! m_state.typed() );
+  assert( k.size() == particles.rows() );
+  assert( b.size() == particles.rows() );
+  assert( r0.size() == particles.rows() );
+  assert( e.size() == particles.rows() );
+
+  // pairs, parameters, breaking criterion
+  m_state.append(particles);
+
+  PairState::join(m_k , k);
+  PairState::join(m_b , b);
+  PairState::join(m_r0, r0);
+  PairState::join(m_e , e);
+
+  append_rupture(D_c, particles.rows());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void PotentialAdhesion::append(const MatS &particles, const ColT &type, const ColD &D_c)
+{
+  // check input
+  assert( m_state.typed() );
+  assert( type.size() == particles.rows() );
+  assert( type.size() == 0 || type.maxCoeff() < m_k.size() );
+
+  // pairs, breaking criterion (the table is kept)
+  m_state.append(particles, type);
+
+  append_rupture(D_c, particles.rows());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void PotentialAdhesion::compact_param(const ColS &index)
+{
+  m_state.compact(m_k , index);
+  m_state.compact(m_b , index);
+  m_state.compact(m_r0, index);
+  m_state.compact(m_e , index);
+
+  m_D_c = PairState::select(m_D_c, index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void PotentialAdhesion::append_rupture(const ColD &D_c, Eigen::Index m)
+{
+  // unbreakable
+  if ( D_c.size() == 0 )
+  {
+    ColD inf = ColD::Constant(m, std::numeric_limits<double>::infinity());
+    PairState::join(m_D_c, inf);
+    return;
+  }
+
+  // check input
+  assert( D_c.size() == m );
+
+  // store, enable the check if some of the new pairs can break
+  PairState::join(m_D_c, D_c);
+
+  m_rupture = m_rupture || ( D_c.array() < std::numeric_limits<double>::infinity() ).any();
+}
+
+// -------------------------------------------------------------------------------------------------
+
 }}} // namespace ...
 
 // -------------------------------------------------------------------------------------------------
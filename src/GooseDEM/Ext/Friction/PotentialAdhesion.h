@@ -28,26 +28,131 @@ class PotentialAdhesion
 {
 private:
 
-  MatS m_particles; // particle pairs       [n, ndim]
-  ColD m_k;         // stiffness            [n]
-  ColD m_b;         // maximal force        [n]
-  ColD m_r0;        // equilibrium length   [n]
-  ColD m_e;         // potential factor     [n]
+  // constants of a pair, derived from its parameters
+  struct Constants
+  {
+    double k;   // stiffness
+    double r0;  // equilibrium length
+    double e;   // potential factor
+    double e12; // "12 * e"
+    double r06; // "r0^6"
+    double kb;  // "k * b"
+    double k2b; // "k^2 * b"
+    double c2;  // "2 / (k * b)"
+    double V0;  // "4 / (k * b^2) - e"
+  };
+
+  PairState m_state; // topology (can be shared), type and active state of each pair
+  ColD m_k;         // stiffness            [n] or [ntype]
+  ColD m_b;         // maximal force        [n] or [ntype]
+  ColD m_r0;        // equilibrium length   [n] or [ntype]
+  ColD m_e;         // potential factor     [n] or [ntype]
+
+  // derived constants per type [ntype] (only for a parameter table)
+  std::vector<Constants> m_table;
+
+  // breaking criterion
+  ColD m_D_c;       // critical distance    [n]
+  bool m_rupture;   // true if some pairs can break
 
 public:
 
-  // constructor
-  PotentialAdhesion(){};
-  PotentialAdhesion(const MatS &particles, const ColD &k, const ColD &b, const ColD &r0, const ColD &e);
+  // constructor (the topology can be shared between models)
+  PotentialAdhesion();
+  PotentialAdhesion(MatS particles, ColD k, ColD b, ColD r0, ColD e);
+  PotentialAdhesion(std::shared_ptr<const Topology> topology,
+    ColD k, ColD b, ColD r0, ColD e);
+
+  // constructor with a parameter table: the parameters are given per type [ntype], each pair
+  // refers to a row of the table by its type [n] (the derived constants are precomputed per type)
+  PotentialAdhesion(MatS particles, ColT type, ColD k, ColD b, ColD r0, ColD e);
+  PotentialAdhesion(std::shared_ptr<const Topology> topology,
+    ColT type, ColD k, ColD b, ColD r0, ColD e);
 
   // compute the force on each particle (the output could contain many zero rows)
   MatD force(const MatD &x) const;
+  MatD force(const MatD &x, const Periodic &box) const;
+
+  // add the force of the pairs "index" [m] to the force on each particle "F" [N, ndim]; pairs that
+  // do not share a particle (e.g. of one color, see "Topology::colored") can be added concurrently
+  void force(const MatD &x, const Periodic &box, const Index *index, size_t m, MatD &F) const;
 
   // compute the coordination of each particle
   ColS coordination(const MatD &X) const;
 
+  // deactivate (break) pairs, by their index [m]
+  void deactivate(const ColS &index);
+
+  // return the active (1) or broken (0) state of each pair [n], and the number of broken pairs
+  const ColB& active() const;
+  size_t      ndead()  const;
+
+  // remove the broken pairs (in a new topology), return the former index of each remaining pair
+  ColS compact();
+
+  // replace the topology by one that contains the former pairs "index" (e.g. the topology that
+  // resulted from "compact" of another model that shared the topology)
+  void compact(std::shared_ptr<const Topology> topology, const ColS &index);
+
+  // append pairs [m, 2] (e.g. the interactions of inserted particles), with their parameters [m],
+  // or their type [m] if the parameters are stored per type, and (optionally) their critical
+  // distance [m] (default: unbreakable); the topology is no longer shared with other models
+  void append(const MatS &particles, const ColD &k, const ColD &b, const ColD &r0, const ColD &e,
+    const ColD &D_c=ColD());
+  void append(const MatS &particles, const ColT &type, const ColD &D_c=ColD());
+
+  // set the critical distance at which a pair breaks [n] (default: infinite, unbreakable)
+  void set_rupture(const ColD &D_c);
+
+  // break the pairs for which the critical distance is exceeded (at the given positions), return
+  // their index
+  ColS rupture(const MatD &x, const Periodic &box);
+
+  // return parameters (per pair [n], also if they are stored per type)
+  std::shared_ptr<const Topology> topology() const;
+  const MatS& particles() const;
+  ColD k()         const;
+  ColD b()         const;
+  ColD r0()        const;
+  ColD e()         const;
+  ColD D_c()       const;
+
+  // return the type of each pair [n] and the number of types (both empty if the parameters are
+  // stored per pair)
+  ColT   type()  const;
+  size_t ntype() const;
+
   // compute the potential energy for each interacted pair
   ColD potential(const MatD &x) const;
+  ColD potential(const MatD &x, const Periodic &box) const;
+
+  // compute the stiffness of each interacted pair: the largest eigenvalue (in absolute value) of
+  // the tangent of the force w.r.t. the position difference
+  ColD stiffness(const MatD &x, const Periodic &box) const;
+
+  // compute the tangent of the force on the first particle w.r.t. the position difference, for
+  // each interacted pair [n, ndim*ndim] (row-major blocks)
+  MatD tangent(const MatD &x, const Periodic &box) const;
+
+private:
+
+  // constructor from the state of the pairs (per pair or per type)
+  PotentialAdhesion(PairState state, ColD k, ColD b, ColD r0, ColD e);
+
+  // add the force of the pairs "pair(0), ..., pair(m-1)" to "F" [N, ndim]
+  template <class P>
+  void add_force(const MatD &x, const Periodic &box, size_t m, P pair, MatD &F) const;
+
+  // constants of pair "p": from the table, or derived from the parameters of the pair
+  Constants constants(size_t p) const;
+  static Constants constants(double k, double b, double r0, double e);
+
+  // keep the parameters of the former pairs "index" (after compacting the pairs)
+  void compact_param(const ColS &index);
+
+  // append the critical distance of "m" new pairs (empty: unbreakable)
+  void append_rupture(const ColD &D_c, Eigen::Index m);
+
 };
 
 // -------------------------------------------------------------------------------------------------
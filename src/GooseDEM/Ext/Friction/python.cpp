@@ -9,6 +9,7 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/eigen.h>
+#include <pybind11/stl.h>
 
 #include <cppmat/pybind11.h>
 
@@ -27,11 +28,46 @@ typedef GooseDEM::ColD ColD;
 typedef GooseDEM::ColS ColS;
 typedef GooseDEM::MatD MatD;
 typedef GooseDEM::MatS MatS;
+typedef GooseDEM::ColT ColT;
 // - const arrays
 typedef const GooseDEM::ColD cColD;
 typedef const GooseDEM::ColS cColS;
 typedef const GooseDEM::MatD cMatD;
 typedef const GooseDEM::MatS cMatS;
+// - non-owning views of (row-major) integer arrays, e.g. "np.load(..., mmap_mode='r')"
+typedef Eigen::Matrix<int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatI32;
+typedef Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatI64;
+typedef Eigen::Ref<const MatI32> rMatI32;
+typedef Eigen::Ref<const MatI64> rMatI64;
+
+// =================================================================================================
+
+// construct the topology directly from the integer data (only a strided view is first copied)
+template <class T>
+std::shared_ptr<const M::Topology> topology(const Eigen::Ref<const T> &particles, size_t N=0)
+{
+  if ( particles.cols() != 2 ) throw std::runtime_error("GooseDEM: particle pairs must be [n, 2]");
+
+  if ( particles.outerStride() == 2 )
+    return std::make_shared<const M::Topology>(particles.data(), particles.rows(), N);
+
+  T copy = particles;
+
+  return std::make_shared<const M::Topology>(copy.data(), copy.rows(), N);
+}
+
+// convert integer data to indices, checking that they are non-negative and fit in the index type
+template <class T>
+MatS indices(const Eigen::Ref<const T> &data)
+{
+  if ( data.size() > 0 && data.minCoeff() < 0 )
+    throw std::runtime_error("GooseDEM: negative index");
+
+  if ( data.size() > 0 && static_cast<uint64_t>(data.maxCoeff()) > std::numeric_limits<M::Index>::max() )
+    throw std::runtime_error("GooseDEM: index exceeds the index type");
+
+  return data.template cast<M::Index>();
+}
 
 // =================================================================================================
 
@@ -44,7 +80,7 @@ m.doc() = "Friction simulation";
 py::class_<E::PotentialAdhesion>(m, "PotentialAdhesion")
   // constructor
   .def(
-    py::init<cMatS &, cColD &, cColD &, cColD &, cColD &>(),
+    py::init<MatS, ColD, ColD, ColD, ColD>(),
     "PotentialAdhesion",
     py::arg("particles"),
     py::arg("k"),
@@ -52,10 +88,90 @@ py::class_<E::PotentialAdhesion>(m, "PotentialAdhesion")
     py::arg("r0"),
     py::arg("e")
   )
+  .def(
+    py::init([](rMatI32 particles, ColD k, ColD b, ColD r0, ColD e) {
+      return E::PotentialAdhesion(topology<MatI32>(particles),
+        std::move(k), std::move(b), std::move(r0), std::move(e));
+    }),
+    "PotentialAdhesion (int32 particles, without copy)",
+    py::arg("particles"),
+    py::arg("k"),
+    py::arg("b"),
+    py::arg("r0"),
+    py::arg("e")
+  )
+  .def(
+    py::init([](rMatI64 particles, ColD k, ColD b, ColD r0, ColD e) {
+      return E::PotentialAdhesion(topology<MatI64>(particles),
+        std::move(k), std::move(b), std::move(r0), std::move(e));
+    }),
+    "PotentialAdhesion (int64 particles, without copy)",
+    py::arg("particles"),
+    py::arg("k"),
+    py::arg("b"),
+    py::arg("r0"),
+    py::arg("e")
+  )
+  .def(
+    py::init([](std::shared_ptr<M::Topology> topology, ColD k, ColD b, ColD r0, ColD e) {
+      return E::PotentialAdhesion(topology,
+        std::move(k), std::move(b), std::move(r0), std::move(e));
+    }),
+    "PotentialAdhesion (shared topology)",
+    py::arg("topology"),
+    py::arg("k"),
+    py::arg("b"),
+    py::arg("r0"),
+    py::arg("e")
+  )
+  .def(
+    py::init<MatS, ColT, ColD, ColD, ColD, ColD>(),
+    "PotentialAdhesion (parameters per type)",
+    py::arg("particles"),
+    py::arg("type"),
+    py::arg("k"),
+    py::arg("b"),
+    py::arg("r0"),
+    py::arg("e")
+  )
+  .def(
+    py::init([](std::shared_ptr<M::Topology> topology, ColT type, ColD k, ColD b, ColD r0, ColD e) {
+      return E::PotentialAdhesion(topology, std::move(type),
+        std::move(k), std::move(b), std::move(r0), std::move(e));
+    }),
+    "PotentialAdhesion (shared topology, parameters per type)",
+    py::arg("topology"),
+    py::arg("type"),
+    py::arg("k"),
+    py::arg("b"),
+    py::arg("r0"),
+    py::arg("e")
+  )
   // methods
-  .def("force"       , &E::PotentialAdhesion::force       )
+  .def("force"       , py::overload_cast<cMatD &                  >(&E::PotentialAdhesion::force, py::const_))
+  .def("force"       , py::overload_cast<cMatD &, const M::Periodic &>(&E::PotentialAdhesion::force, py::const_))
   .def("coordination", &E::PotentialAdhesion::coordination)
-  .def("potential"   , &E::PotentialAdhesion::potential   )
+  .def("stiffness"   , &E::PotentialAdhesion::stiffness   )
+  .def("tangent"     , &E::PotentialAdhesion::tangent     )
+  .def("particles"   , &E::PotentialAdhesion::particles   )
+  .def("D_c"         , &E::PotentialAdhesion::D_c         )
+  .def("k"           , &E::PotentialAdhesion::k           )
+  .def("b"           , &E::PotentialAdhesion::b           )
+  .def("r0"          , &E::PotentialAdhesion::r0          )
+  .def("e"           , &E::PotentialAdhesion::e           )
+  .def("type"        , &E::PotentialAdhesion::type        )
+  .def("ntype"       , &E::PotentialAdhesion::ntype       )
+  .def("set_rupture" , &E::PotentialAdhesion::set_rupture , py::arg("D_c"))
+  .def("rupture"     , &E::PotentialAdhesion::rupture     , py::arg("x"), py::arg("box")=M::Periodic())
+  .def("deactivate"  , &E::PotentialAdhesion::deactivate  , py::arg("index"))
+  .def("active"      , &E::PotentialAdhesion::active      )
+  .def("ndead"       , &E::PotentialAdhesion::ndead       )
+  .def("compact"     , py::overload_cast<>(&E::PotentialAdhesion::compact))
+  .def("append"      , py::overload_cast<cMatS &, cColD &, cColD &, cColD &, cColD &, cColD &>(&E::PotentialAdhesion::append), py::arg("particles"), py::arg("k"), py::arg("b"), py::arg("r0"), py::arg("e"), py::arg("D_c")=ColD())
+  .def("append"      , py::overload_cast<cMatS &, const ColT &, cColD &>(&E::PotentialAdhesion::append), py::arg("particles"), py::arg("type"), py::arg("D_c")=ColD())
+  .def("topology"    , [](const E::PotentialAdhesion &a){ return std::const_pointer_cast<M::Topology>(a.topology()); })
+  .def("potential"   , py::overload_cast<cMatD &                  >(&E::PotentialAdhesion::potential, py::const_))
+  .def("potential"   , py::overload_cast<cMatD &, const M::Periodic &>(&E::PotentialAdhesion::potential, py::const_))
   // print to screen
   .def("__repr__",
     [](const E::PotentialAdhesion &a){ return "<GooseDEM_Ext_Friction.PotentialAdhesion>"; }
@@ -63,20 +179,70 @@ py::class_<E::PotentialAdhesion>(m, "PotentialAdhesion")
 
 // =============================== GooseDEM/Ext/Friction/Geometry.h ================================
 
+py::enum_<E::MassScaling>(m, "MassScaling")
+  .value("none"     , E::MassScaling::none     )
+  .value("uniform"  , E::MassScaling::uniform  )
+  .value("selective", E::MassScaling::selective);
+
+// -------------------------------------------------------------------------------------------------
+
 py::class_<E::Geometry, M::Geometry>(m, "Geometry")
   // constructor
   .def(
-    py::init<cColD &, cMatD &, cMatS &>(),
+    py::init<ColD, MatD, MatS>(),
     "Geometry",
     py::arg("m"),
     py::arg("x"),
     py::arg("dofs")
   )
+  .def(
+    py::init([](ColD m, MatD x, rMatI32 dofs) {
+      return E::Geometry(std::move(m), std::move(x), indices<MatI32>(dofs));
+    }),
+    "Geometry (int32 DOF-numbers, checked)",
+    py::arg("m"),
+    py::arg("x"),
+    py::arg("dofs")
+  )
+  .def(
+    py::init([](ColD m, MatD x, rMatI64 dofs) {
+      return E::Geometry(std::move(m), std::move(x), indices<MatI64>(dofs));
+    }),
+    "Geometry (int64 DOF-numbers, checked)",
+    py::arg("m"),
+    py::arg("x"),
+    py::arg("dofs")
+  )
   // methods
   // -
-  .def("set", py::overload_cast<const M::Spring            &>(&E::Geometry::set))
-  .def("set", py::overload_cast<const M::Dashpot           &>(&E::Geometry::set))
-  .def("set", py::overload_cast<const E::PotentialAdhesion &>(&E::Geometry::set))
+  .def("set", py::overload_cast<const M::Spring            &, size_t>(&E::Geometry::set), py::arg("mat"), py::arg("level")=0)
+  .def("set", py::overload_cast<const M::Dashpot           &, size_t>(&E::Geometry::set), py::arg("mat"), py::arg("level")=0)
+  .def("set", py::overload_cast<const E::PotentialAdhesion &, size_t>(&E::Geometry::set), py::arg("mat"), py::arg("level")=0)
+  .def("set", py::overload_cast<const M::Periodic          &>(&E::Geometry::set))
+  .def("add", py::overload_cast<const M::Spring            &, size_t>(&E::Geometry::add), py::arg("mat"), py::arg("level")=0)
+  .def("add", py::overload_cast<const M::Dashpot           &, size_t>(&E::Geometry::add), py::arg("mat"), py::arg("level")=0)
+  .def("add", py::overload_cast<const E::PotentialAdhesion &, size_t>(&E::Geometry::add), py::arg("mat"), py::arg("level")=0)
+  .def("append", py::overload_cast<const M::Spring            &, size_t>(&E::Geometry::append), py::arg("mat"), py::arg("index")=0)
+  .def("append", py::overload_cast<const M::Dashpot           &, size_t>(&E::Geometry::append), py::arg("mat"), py::arg("index")=0)
+  .def("append", py::overload_cast<const E::PotentialAdhesion &, size_t>(&E::Geometry::append), py::arg("mat"), py::arg("index")=0)
+  .def("set", py::overload_cast<const M::Wall              &, size_t>(&E::Geometry::set), py::arg("wall"), py::arg("level")=0)
+  .def("add", py::overload_cast<const M::Wall              &, size_t>(&E::Geometry::add), py::arg("wall"), py::arg("level")=0)
+  .def("nmodel", &E::Geometry::nmodel)
+  .def("nwall" , &E::Geometry::nwall )
+  .def("wall_reaction", &E::Geometry::wall_reaction)
+  .def("set_nthread", &E::Geometry::set_nthread, py::arg("nthread"), py::arg("nconcurrent")=10000)
+  .def("box", &E::Geometry::box)
+  .def("set_mass_scaling", &E::Geometry::set_mass_scaling, py::arg("scaling"), py::arg("dt")=0.0)
+  .def("added_mass"      , &E::Geometry::added_mass      )
+  .def("added_kinetic"   , &E::Geometry::added_kinetic   )
+  .def("set_compaction", &E::Geometry::set_compaction, py::arg("fraction"))
+  .def("insert"        , &E::Geometry::insert, py::arg("x"), py::arg("m"), py::arg("v")=MatD())
+  .def("remove"        , &E::Geometry::remove , py::arg("particles"))
+  .def("reserve"       , &E::Geometry::reserve, py::arg("N"))
+  .def("compact"       , &E::Geometry::compact)
+  .def("vacant"        , &E::Geometry::vacant )
+  .def("nvacant"       , &E::Geometry::nvacant)
+  .def("broken"        , &E::Geometry::broken)
   // -
   .def("fix_v"    , &E::Geometry::fix_v   )
   .def("set_fext" , &E::Geometry::set_fext)
@@ -86,14 +252,26 @@ py::class_<E::Geometry, M::Geometry>(m, "Geometry")
   .def("x"           , &E::Geometry::x           )
   .def("v"           , &E::Geometry::v           )
   .def("a"           , &E::Geometry::a           )
-  .def("f"           , &E::Geometry::f           )
+  .def("f"           , py::overload_cast<       >(&E::Geometry::f, py::const_))
+  .def("f"           , py::overload_cast<size_t >(&E::Geometry::f, py::const_), py::arg("level"))
+  .def("solve"       , &E::Geometry::solve       )
+  .def("solve_level" , &E::Geometry::solve_level , py::arg("level"))
   .def("m"           , &E::Geometry::m           )
   .def("coordination", &E::Geometry::coordination)
+  .def("dt_crit"     , &E::Geometry::dt_crit     )
+  .def("kinetic"     , &E::Geometry::kinetic     )
+  .def("potential"   , &E::Geometry::potential   )
+  .def("energy"      , &E::Geometry::energy      )
   // -
   .def("dofs_v", &E::Geometry::dofs_v)
   .def("dofs_a", &E::Geometry::dofs_a)
   .def("dofs_f", &E::Geometry::dofs_f)
   .def("dofs_m", &E::Geometry::dofs_m)
+  .def("dofs_K", &E::Geometry::dofs_K)
+  .def("dofs_C", &E::Geometry::dofs_C)
+  .def("iip"   , &E::Geometry::iip   )
+  .def("iip_fixed", &E::Geometry::iip_fixed)
+  .def("asParticle", &E::Geometry::asParticle)
   // -
   .def("set_v", py::overload_cast<cColD &>(&E::Geometry::set_v))
   .def("set_a", py::overload_cast<cColD &>(&E::Geometry::set_a))
@@ -105,6 +283,37 @@ py::class_<E::Geometry, M::Geometry>(m, "Geometry")
     [](const E::Geometry &a){ return "<GooseDEM_Ext_Friction.Geometry>"; }
   );
 
+// ================================ GooseDEM/Ext/Friction/Loading.h ================================
+
+py::enum_<E::Predictor>(m, "Predictor")
+  .value("none"  , E::Predictor::none  )
+  .value("affine", E::Predictor::affine)
+  .value("secant", E::Predictor::secant);
+
+// -------------------------------------------------------------------------------------------------
+
+py::class_<E::Loading>(m, "Loading")
+  // constructor
+  .def(
+    py::init<E::Geometry &, double, const M::Convergence &, E::Predictor>(),
+    "Loading: quasi-static load stepping",
+    py::arg("geometry"),
+    py::arg("dt"),
+    py::arg("convergence"),
+    py::arg("predictor")=E::Predictor::secant,
+    py::keep_alive<1,2>()
+  )
+  // methods
+  .def("increment" , &E::Loading::increment, py::arg("fext"), py::arg("up")=ColD(), py::arg("F")=MatD())
+  .def("run"       , &E::Loading::run      , py::arg("fext"))
+  .def("size"      , &E::Loading::size      )
+  .def("iterations", &E::Loading::iterations)
+  .def("reaction"  , &E::Loading::reaction  )
+  // print to screen
+  .def("__repr__",
+    [](const E::Loading &a){ return "<GooseDEM_Ext_Friction.Loading>"; }
+  );
+
 // =================================================================================================
 
 }
@@ -17,9 +17,46 @@ namespace GooseDEM {
 
 // -------------------------------------------------------------------------------------------------
 
-MatD distance(const MatD &x)
+inline MatD distance(const MatD &x)
 {
-  // TODO
+  return distance(x, Periodic());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD distance(const MatD &X, const Periodic &box)
+{
+  // dimensions
+  auto n    = X.rows(); // number of particles
+  auto ndim = X.cols(); // number of dimensions
+
+  // zero-initialize distance between all particles
+  MatD D = MatD::Zero(n, n);
+
+  // local variables
+  cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
+  cppmat::cartesian::vector<double> xj(ndim); // position of particle "j"
+  cppmat::cartesian::vector<double> dx(ndim); // position difference
+
+  // loop over all particle pairs
+  for ( auto i = 0 ; i < n ; ++i )
+  {
+    for ( auto j = i+1 ; j < n ; ++j )
+    {
+      // - copy the particles' positions to the vectors "xi" and "xj"
+      std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
+      std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
+      // - compute the position difference vector
+      dx = xj - xi;
+      // - apply periodicity
+      box.minimumImage(dx.data());
+      // - store the distance
+      D(i,j) = dx.length();
+      D(j,i) = D(i,j);
+    }
+  }
+
+  return D;
 }
 
 // -------------------------------------------------------------------------------------------------
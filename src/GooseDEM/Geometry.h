@@ -24,6 +24,15 @@ public:
   // solve for DOF-accelerations [ndof]
   virtual ColD solve() { return ColD(); };
 
+  // solve for DOF-accelerations [ndof], due only to the interactions at a certain level of a
+  // multiple-time-stepping scheme (level 0: fast, including external forces; level 1: slow)
+  // default: all interactions are fast
+  virtual ColD solve_level(size_t level)
+  {
+    if ( level == 0 ) return solve();
+    return ColD::Zero(dofs_a().size());
+  };
+
   // reset residuals, check for convergence
   virtual void reset()          { return;       }
   virtual bool stop(double tol) { UNUSED(tol); return false; };
@@ -31,14 +40,35 @@ public:
   // process time-step
   virtual void timestep(double dt) { UNUSED(dt); return; };
 
+  // estimate the critical (largest stable) time step (default: unknown)
+  virtual double dt_crit() const { return std::numeric_limits<double>::infinity(); };
+
+  // return the total (kinetic + potential) energy (default: unknown)
+  virtual double energy() const { return 0.0; };
+
+  // return the potential energy (default: unknown)
+  virtual double potential() const { return 0.0; };
+
   // return particle vectors [N, ndim]
   virtual MatD x() const { return MatD(); };
   virtual MatD v() const { return MatD(); };
   virtual MatD a() const { return MatD(); };
 
+  // return the coordination of each particle [N] (default: unknown)
+  virtual ColS coordination() const { return ColS(); };
+
   // return DOF values [ndof]
   virtual ColD dofs_v() const { return ColD(); };
   virtual ColD dofs_a() const { return ColD(); };
+  virtual ColD dofs_m() const { return ColD(); };
+
+  // return the prescribed DOFs [np]
+  virtual ColS iip() const { return ColS(); };
+
+  // return the tangent stiffness and damping matrices [ndof, ndof], i.e. the derivative of minus
+  // the internal force w.r.t. the DOF-positions and DOF-velocities (for implicit time integration)
+  virtual SpMatD dofs_K() const { return SpMatD(); };
+  virtual SpMatD dofs_C() const { return SpMatD(); };
 
   // overwrite particle vectors [N, ndim]
   virtual void set_x(const MatD &pvector) { UNUSED(pvector); return; };
@@ -47,12 +77,25 @@ public:
   virtual void set_v(const ColD &dofval) { UNUSED(dofval); return; };
   virtual void set_a(const ColD &dofval) { UNUSED(dofval); return; };
 
+  // reconstruct a particle vector from DOF values: [ndof] -> [N, ndim]
+  virtual MatD asParticle(const ColD &dofval) const { UNUSED(dofval); return MatD(); };
+
+  // mutable views of the particle vectors [N, ndim], and the DOF-numbers [N, ndim], such that the
+  // integrators can update the state in-place. The particle vectors must be consistent with the
+  // DOFs (particles that share a DOF have the same value), the velocity of the prescribed DOFs must
+  // be set. Default: not available ("nullptr"), the integrators then use "x()", "set_x()", etc.
+  virtual MatD*       view_x()          { return nullptr; };
+  virtual MatD*       view_v()          { return nullptr; };
+  virtual MatD*       view_a()          { return nullptr; };
+  virtual const MatS* view_dofs() const { return nullptr; };
+
 };
 
 // -------------------------------------------------------------------------------------------------
 
-// find distance between all particles
-MatD distance(const MatD &x);
+// find distance between all particles [N, N] (in a periodic box: the distance to the nearest image)
+inline MatD distance(const MatD &x);
+inline MatD distance(const MatD &x, const Periodic &box);
 
 // -------------------------------------------------------------------------------------------------
 
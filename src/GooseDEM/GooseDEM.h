@@ -16,11 +16,32 @@
 #include <fstream>
 #include <stdexcept>
 #include <limits>
+#include <vector>
+#include <map>
+#include <memory>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <algorithm>
 #include <math.h>
 #include <iso646.h>
 #include <Eigen/Eigen>
 #include <cppmat/cppmat.h>
 
+// memory mapped files (POSIX)
+#if defined(__unix__) || defined(__APPLE__)
+  #define GOOSEDEM_USE_MMAP
+  #include <fcntl.h>
+  #include <unistd.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+#endif
+
 // ---------------------------------------- dummy operation ----------------------------------------
 
 // dummy operation that can be use to suppress the "unused parameter" warnings
@@ -42,33 +63,73 @@
    GOOSEDEM_MAJOR_VERSION==y && \
    GOOSEDEM_MINOR_VERSION==z)
 
+// ------------------------------------------ index type -------------------------------------------
+
+// type of the indices (particle and DOF numbers, pair lists) stored in "MatS" and "ColS"; e.g.
+// compile with "-DGOOSEDEM_INDEX_TYPE=uint32_t" to halve their memory (and bandwidth), for systems
+// with less than 2^32 particles and DOFs
+#ifndef GOOSEDEM_INDEX_TYPE
+#define GOOSEDEM_INDEX_TYPE size_t
+#endif
+
 // ------------------------------------------ alias types ------------------------------------------
 
 namespace GooseDEM {
 
+  typedef GOOSEDEM_INDEX_TYPE Index;
+
   typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatD;
-  typedef Eigen::Matrix<size_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatS;
+  typedef Eigen::Matrix<Index , Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatS;
   typedef Eigen::Matrix<double, Eigen::Dynamic,              1, Eigen::ColMajor> ColD;
-  typedef Eigen::Matrix<size_t, Eigen::Dynamic,              1, Eigen::ColMajor> ColS;
+  typedef Eigen::Matrix<Index , Eigen::Dynamic,              1, Eigen::ColMajor> ColS;
+
+  // type of each pair, indexing the parameter table of a constitutive model (e.g. "Spring")
+  typedef Eigen::Matrix<uint16_t, Eigen::Dynamic,            1, Eigen::ColMajor> ColT;
+
+  // boolean per item, stored in one byte (e.g. the active state of each pair)
+  typedef Eigen::Matrix<uint8_t , Eigen::Dynamic,            1, Eigen::ColMajor> ColB;
+
+  typedef Eigen::SparseMatrix<double> SpMatD;
 
 }
 
 // -------------------------------------------------------------------------------------------------
 
 #include "Write.h"
+#include "Trajectory.h"
+#include "AsyncWriter.h"
+#include "Parallel.h"
+#include "Periodic.h"
+#include "Topology.h"
+#include "PairState.h"
 #include "Spring.h"
 #include "Dashpot.h"
+#include "Wall.h"
 #include "Iterate.h"
 #include "Vector.h"
 #include "Geometry.h"
+#include "Observer.h"
 #include "TimeIntegration.h"
+#include "Minimize.h"
+#include "Load.h"
 
 #include "Write.cpp"
+#include "Trajectory.cpp"
+#include "AsyncWriter.cpp"
+#include "Parallel.cpp"
+#include "Periodic.cpp"
+#include "Topology.cpp"
+#include "PairState.cpp"
 #include "Spring.cpp"
 #include "Dashpot.cpp"
+#include "Wall.cpp"
 #include "Iterate.cpp"
 #include "Vector.cpp"
+#include "Geometry.cpp"
+#include "Observer.cpp"
 #include "TimeIntegration.cpp"
+#include "Minimize.cpp"
+#include "Load.cpp"
 
 // -------------------------------------------------------------------------------------------------
 
@@ -71,6 +71,158 @@ inline bool StopList::stop(double res, double tol)
   return true;
 }
 
+// ------------------------------------------ constructor ------------------------------------------
+
+inline Convergence::Convergence(size_t stride, size_t max_stride, double growth, size_t nhistory) :
+  m_nhistory(nhistory), m_stride0(stride), m_max_stride(std::max(stride, max_stride)),
+  m_growth(growth)
+{
+  assert( stride   >  0  );
+  assert( growth   >= 1. );
+  assert( nhistory >  0  );
+
+  reset();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Convergence::add(Criterion criterion, double tol)
+{
+  m_criterion.push_back(criterion);
+  m_tol      .push_back(tol);
+  m_stop     .push_back(StopList(m_nhistory));
+
+  reset();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Convergence::reset()
+{
+  for ( auto &stop : m_stop ) stop.reset();
+
+  m_stride = m_stride0;
+  m_next   = m_stride0;
+  m_ncheck = 0;
+  m_value  = ColD::Constant(m_criterion.size(), std::numeric_limits<double>::infinity());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool Convergence::check(size_t iiter) const
+{
+  return iiter >= m_next;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool Convergence::stop(const ColD &M, const ColD &V, const ColD &A, double dt)
+{
+  // check input
+  assert( m_criterion.size() > 0 );
+  assert( M.size() == V.size() );
+  assert( M.size() == A.size() );
+
+  // reductions over the DOFs, in a single pass over ranges of DOFs (each with its own partial
+  // result, that are combined in a fixed order)
+  size_t n       = static_cast<size_t>(M.size());
+  size_t grain   = 16384;
+  size_t nrange  = ( n + grain - 1 ) / grain;
+  size_t nthread = n >= 2 * grain ? default_nthread() : 1;
+
+  // partial results [nrange, 5]: L1, L2^2, max of the residual, kinetic energy, displacement
+  MatD part = MatD::Zero(nrange, 5);
+
+  parallel_for(nrange, nthread, [&](size_t r)
+  {
+    double l1 = 0.0, l2 = 0.0, lmax = 0.0, kinetic = 0.0, dx = 0.0;
+
+    for ( size_t i = r * grain ; i < std::min((r+1) * grain, n) ; ++i )
+    {
+      double res = std::abs( M(i) * A(i) );
+
+      l1      += res;
+      l2      += res * res;
+      lmax     = std::max(lmax, res);
+      kinetic += M(i) * V(i) * V(i);
+      dx       = std::max(dx, std::abs( dt * V(i) + .5 * dt * dt * A(i) ));
+    }
+
+    part(r,0) = l1;
+    part(r,1) = l2;
+    part(r,2) = lmax;
+    part(r,3) = kinetic;
+    part(r,4) = dx;
+  });
+
+  double l1 = 0.0, l2 = 0.0, lmax = 0.0, kinetic = 0.0, dx = 0.0;
+
+  for ( size_t r = 0 ; r < nrange ; ++r )
+  {
+    l1      += part(r,0);
+    l2      += part(r,1);
+    lmax     = std::max(lmax, part(r,2));
+    kinetic += part(r,3);
+    dx       = std::max(dx, part(r,4));
+  }
+
+  // update the history of each criterion
+  ColD value(m_criterion.size());
+
+  bool stop     = true;
+  bool decrease = true;
+
+  for ( size_t c = 0 ; c < m_criterion.size() ; ++c )
+  {
+    switch ( m_criterion[c] )
+    {
+      case Criterion::residual_L1 : value(c) = l1;             break;
+      case Criterion::residual_L2 : value(c) = std::sqrt(l2);  break;
+      case Criterion::residual_max: value(c) = lmax;           break;
+      case Criterion::kinetic     : value(c) = .5 * kinetic;   break;
+      case Criterion::displacement: value(c) = dx;             break;
+    }
+
+    if ( ! m_stop[c].stop(value(c), m_tol[c]) ) stop = false;
+
+    if ( ! ( value(c) < m_value(c) ) ) decrease = false;
+  }
+
+  m_value   = value;
+  m_ncheck += 1;
+
+  // adapt the stride: grow while the criteria decrease, reset otherwise
+  if ( decrease )
+    m_stride = std::min(m_max_stride, static_cast<size_t>(std::ceil(m_growth * m_stride)));
+  else
+    m_stride = m_stride0;
+
+  m_next += m_stride;
+
+  return stop;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::vector<Criterion> Convergence::criteria() const
+{
+  return m_criterion;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Convergence::values() const
+{
+  return m_value;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Convergence::ncheck() const
+{
+  return m_ncheck;
+}
+
 // -------------------------------------------------------------------------------------------------
 
 } // namespace ...
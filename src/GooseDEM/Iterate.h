@@ -40,6 +40,72 @@ public:
 
 // -------------------------------------------------------------------------------------------------
 
+// convergence criteria, evaluated on the free DOFs (see "Convergence")
+enum class Criterion
+{
+  residual_L1,  // sum of the absolute residual forces "|M A|"
+  residual_L2,  // Euclidean norm of the residual forces "M A"
+  residual_max, // largest absolute residual force "|M A|"
+  kinetic,      // kinetic energy "1/2 V^T M V"
+  displacement  // largest absolute displacement of the next time step "|dt V + 1/2 dt^2 A|"
+};
+
+// -------------------------------------------------------------------------------------------------
+
+// Convergence check of a quasi-static relaxation, with any number of criteria that must all be
+// satisfied. Each criterion keeps a history of its last "nhistory" values (see "StopList"). All
+// criteria are evaluated in a single (parallel) pass over the DOFs. The check is amortized by
+// evaluating it only every "stride" iterations: the stride is multiplied by "growth" (up to
+// "max_stride") after each check at which all criteria decreased, and is reset otherwise.
+
+class Convergence
+{
+private:
+
+  // criteria, their tolerance and history
+  std::vector<Criterion> m_criterion;
+  std::vector<double>    m_tol;
+  std::vector<StopList>  m_stop;
+  size_t                 m_nhistory;
+
+  // stride: initial, maximal, growth factor, current, iteration of the next check
+  size_t m_stride0;
+  size_t m_max_stride;
+  double m_growth;
+  size_t m_stride;
+  size_t m_next;
+
+  // value of each criterion at the last check, number of checks
+  ColD   m_value;
+  size_t m_ncheck;
+
+public:
+
+  // constructor
+  Convergence(size_t stride=1, size_t max_stride=1, double growth=2., size_t nhistory=1);
+
+  // append a criterion, with an absolute tolerance
+  void add(Criterion criterion, double tol);
+
+  // reset for a new relaxation (the history and the stride)
+  void reset();
+
+  // return true if convergence has to be checked after iteration "iiter" (counting from 1)
+  bool check(size_t iiter) const;
+
+  // evaluate the criteria for DOF-masses "M", DOF-velocities "V" and DOF-accelerations "A" (with
+  // zero entries for the prescribed DOFs), and time step "dt"; return true if all are satisfied
+  bool stop(const ColD &M, const ColD &V, const ColD &A, double dt);
+
+  // return the criteria, their value at the last check, and the number of checks since "reset"
+  std::vector<Criterion> criteria() const;
+  ColD                   values()   const;
+  size_t                 ncheck()   const;
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
 } // namespace ...
 
 // =================================================================================================
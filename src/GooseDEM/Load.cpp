@@ -0,0 +1,323 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_LOAD_CPP
+#define GOOSEDEM_LOAD_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "Load.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// ------------------------------------------ constructor ------------------------------------------
+
+inline Npy::Npy(const std::string &fname)
+{
+  // map the complete file
+  map(fname, 0);
+
+  // parse the header, and skip it
+  m_data += header(m_data, m_bytes);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Npy::Npy(const std::string &fname, const std::string &descr,
+  const std::vector<size_t> &shape, size_t offset) : m_descr(descr), m_shape(shape)
+{
+  // check input
+  check_descr();
+
+  // number of items
+  m_size = 1;
+
+  for ( auto &n : m_shape ) m_size *= n;
+
+  // map the file
+  map(fname, offset);
+
+  // check the size
+  if ( m_bytes < offset + m_size * static_cast<size_t>(std::stoi(m_descr.substr(2))) )
+    throw std::runtime_error("GooseDEM::Npy: file too small for the specified shape");
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Npy::~Npy()
+{
+#ifdef GOOSEDEM_USE_MMAP
+  if ( m_map ) munmap(m_map, m_bytes);
+#endif
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Npy::map(const std::string &fname, size_t offset)
+{
+#ifdef GOOSEDEM_USE_MMAP
+
+  // open the file
+  int fd = open(fname.c_str(), O_RDONLY);
+
+  if ( fd < 0 ) throw std::runtime_error("GooseDEM::Npy: unable to open '"+fname+"'");
+
+  // get the size of the file
+  struct stat info;
+
+  if ( fstat(fd, &info) != 0 )
+  {
+    close(fd);
+    throw std::runtime_error("GooseDEM::Npy: unable to read '"+fname+"'");
+  }
+
+  m_bytes = static_cast<size_t>(info.st_size);
+
+  // map the file (read-only), the mapping remains valid after closing the file
+  if ( m_bytes > 0 )
+  {
+    m_map = mmap(nullptr, m_bytes, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if ( m_map == MAP_FAILED )
+    {
+      m_map = nullptr;
+      close(fd);
+      throw std::runtime_error("GooseDEM::Npy: unable to map '"+fname+"'");
+    }
+  }
+
+  close(fd);
+
+  m_data = static_cast<const char*>(m_map);
+
+#else
+
+  // read the complete file
+  std::ifstream file(fname.c_str(), std::ios::binary | std::ios::ate);
+
+  if ( ! file ) throw std::runtime_error("GooseDEM::Npy: unable to open '"+fname+"'");
+
+  m_bytes = static_cast<size_t>(file.tellg());
+
+  m_buffer.resize(m_bytes);
+
+  file.seekg(0);
+  file.read(m_buffer.data(), m_bytes);
+
+  m_data = m_buffer.data();
+
+#endif
+
+  // check the offset
+  if ( offset > m_bytes ) throw std::runtime_error("GooseDEM::Npy: offset beyond end of file");
+
+  m_data += offset;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Npy::header(const char *data, size_t bytes)
+{
+  // check the magic string "\x93NUMPY"
+  if ( bytes < 10 || std::string(data, 6) != "\x93NUMPY" )
+    throw std::runtime_error("GooseDEM::Npy: not a '.npy' file");
+
+  // length of the header: version 1.0 uses 2 bytes, version 2.0 and 3.0 use 4 bytes
+  const unsigned char *h = reinterpret_cast<const unsigned char*>(data);
+
+  size_t len, start;
+
+  if ( h[6] == 1 ) { len = h[8] | (h[9] << 8);                                  start = 10; }
+  else             { len = h[8] | (h[9] << 8) | (h[10] << 16) | (h[11] << 24); start = 12; }
+
+  if ( bytes < start + len ) throw std::runtime_error("GooseDEM::Npy: truncated header");
+
+  // header: Python dictionary, e.g. "{'descr': '<f8', 'fortran_order': False, 'shape': (3, 2), }"
+  std::string dict(data+start, len);
+
+  // - type description
+  size_t i = dict.find("'descr'");
+  i = dict.find('\'', dict.find(':', i)) + 1;
+  m_descr = dict.substr(i, dict.find('\'', i) - i);
+
+  // - storage order
+  i = dict.find("'fortran_order'");
+  i = dict.find_first_not_of(" ", dict.find(':', i) + 1);
+
+  bool fortran = dict.compare(i, 4, "True") == 0;
+
+  // - shape
+  i = dict.find("'shape'");
+  i = dict.find('(', i) + 1;
+
+  std::string shape = dict.substr(i, dict.find(')', i) - i);
+
+  m_shape.clear();
+
+  for ( size_t k = 0 ; k < shape.size() ; )
+  {
+    size_t n = shape.find_first_of("0123456789", k);
+    if ( n == std::string::npos ) break;
+    size_t e = shape.find_first_not_of("0123456789", n);
+    m_shape.push_back(std::stoull(shape.substr(n, e-n)));
+    k = e;
+  }
+
+  // number of items
+  m_size = 1;
+
+  for ( auto &n : m_shape ) m_size *= n;
+
+  // check input
+  if ( fortran && m_shape.size() > 1 )
+    throw std::runtime_error("GooseDEM::Npy: Fortran ordered data not supported");
+
+  check_descr();
+
+  if ( bytes < start + len + m_size * static_cast<size_t>(std::stoi(m_descr.substr(2))) )
+    throw std::runtime_error("GooseDEM::Npy: truncated data");
+
+  return start + len;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Npy::check_descr()
+{
+  // native byte order: little-endian is assumed
+  if ( m_descr.size() == 3 && m_descr[0] == '=' ) m_descr[0] = '<';
+
+  if ( m_descr.size() != 3 || m_descr[0] != '<' )
+    throw std::runtime_error("GooseDEM::Npy: unsupported type '"+m_descr+"'");
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <> inline std::string Npy::descr<double  >() { return "<f8"; }
+template <> inline std::string Npy::descr<int32_t >() { return "<i4"; }
+template <> inline std::string Npy::descr<int64_t >() { return "<i8"; }
+template <> inline std::string Npy::descr<uint64_t>() { return "<u8"; }
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::string Npy::descr() const
+{
+  return m_descr;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::vector<size_t> Npy::shape() const
+{
+  return m_shape;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Npy::size() const
+{
+  return m_size;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <class T>
+inline const T* Npy::data() const
+{
+  // check the type
+  if ( m_descr != descr<T>() )
+    throw std::runtime_error("GooseDEM::Npy: type mismatch '"+m_descr+"'");
+
+  return reinterpret_cast<const T*>(m_data);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Npy::asColD() const
+{
+  return Eigen::Map<const ColD>(data<double>(), m_size);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Npy::asMatD() const
+{
+  // check input
+  if ( m_shape.size() != 2 ) throw std::runtime_error("GooseDEM::Npy: array must be 2-d");
+
+  return Eigen::Map<const MatD>(data<double>(), m_shape[0], m_shape[1]);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatS Npy::asMatS() const
+{
+  // check input
+  if ( m_shape.size() != 2 ) throw std::runtime_error("GooseDEM::Npy: array must be 2-d");
+
+  // dimensions
+  auto n = m_shape[0];
+  auto m = m_shape[1];
+
+  // convert, check that the indices are non-negative and fit in the index type
+  MatS out(n, m);
+
+  const uint64_t max = std::numeric_limits<Index>::max();
+
+  if ( m_descr == descr<uint64_t>() )
+  {
+    const uint64_t *d = data<uint64_t>();
+    for ( size_t i = 0 ; i < m_size ; ++i )
+      if ( d[i] > max ) throw std::runtime_error("GooseDEM::Npy: index exceeds the index type");
+      else out.data()[i] = static_cast<Index>(d[i]);
+  }
+  else if ( m_descr == descr<int64_t>() )
+  {
+    const int64_t *d = data<int64_t>();
+    for ( size_t i = 0 ; i < m_size ; ++i )
+      if ( d[i] < 0 ) throw std::runtime_error("GooseDEM::Npy: negative index");
+      else if ( static_cast<uint64_t>(d[i]) > max )
+        throw std::runtime_error("GooseDEM::Npy: index exceeds the index type");
+      else out.data()[i] = static_cast<Index>(d[i]);
+  }
+  else
+  {
+    const int32_t *d = data<int32_t>();
+    for ( size_t i = 0 ; i < m_size ; ++i )
+      if ( d[i] < 0 ) throw std::runtime_error("GooseDEM::Npy: negative index");
+      else out.data()[i] = static_cast<Index>(d[i]);
+  }
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::shared_ptr<const Topology> Npy::asTopology(size_t N) const
+{
+  // check input
+  if ( m_shape.size() != 2 || m_shape[1] != 2 )
+    throw std::runtime_error("GooseDEM::Npy: particle pairs must be [n, 2]");
+
+  // convert directly from the mapped data
+  if ( m_descr == descr<int32_t>() )
+    return std::make_shared<const Topology>(data<int32_t>(), m_shape[0], N);
+
+  if ( m_descr == descr<int64_t>() )
+    return std::make_shared<const Topology>(data<int64_t>(), m_shape[0], N);
+
+  return std::make_shared<const Topology>(asMatS(), N);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
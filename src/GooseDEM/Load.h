@@ -0,0 +1,99 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_LOAD_H
+#define GOOSEDEM_LOAD_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include "GooseDEM.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+// Array stored in a NumPy ".npy" file, or in a raw binary file of which the type and shape are
+// specified. The file is memory mapped (POSIX), such that the data is only read from disk once it
+// is converted, e.g. to a "Topology" directly from the 32- or 64-bit integer data. On other
+// platforms the data is read into memory. The types are described as in NumPy: "<f8" (double),
+// "<i4" (int32), "<i8" (int64), "<u8" (uint64); only little-endian data is supported.
+
+class Npy
+{
+private:
+
+  // mapping of the file
+  void  *m_map=nullptr; // start of the mapping
+  size_t m_bytes=0;     // size of the mapping (bytes)
+
+  // fallback: file read into memory
+  std::vector<char> m_buffer;
+
+  // array
+  const char         *m_data=nullptr; // start of the data
+  std::string         m_descr;        // type description, e.g. "<f8"
+  std::vector<size_t> m_shape;        // shape
+  size_t              m_size=0;       // number of items
+
+public:
+
+  // constructor: ".npy" file, or raw binary file with a type description and shape, starting at
+  // "offset" bytes from the beginning of the file
+  Npy() = default;
+  Npy(const std::string &fname);
+  Npy(const std::string &fname, const std::string &descr, const std::vector<size_t> &shape,
+    size_t offset=0);
+
+  // the mapping cannot be copied
+  Npy(const Npy &) = delete;
+  Npy& operator=(const Npy &) = delete;
+
+  // destructor: unmap the file
+  ~Npy();
+
+  // return type description, shape, and number of items
+  std::string         descr() const;
+  std::vector<size_t> shape() const;
+  size_t              size()  const;
+
+  // return pointer to the data (throws if the type does not match)
+  template <class T>
+  const T* data() const;
+
+  // convert to (owned) arrays
+  ColD asColD() const; // any shape, "<f8"
+  MatD asMatD() const; // [rows, cols], "<f8"
+  MatS asMatS() const; // [rows, cols], "<i4", "<i8", or "<u8"
+
+  // convert to a topology: particle pairs [n, 2], "<i4", "<i8", or "<u8"
+  std::shared_ptr<const Topology> asTopology(size_t N=0) const;
+
+private:
+
+  // map the file, and point "m_data" to "offset" bytes from the beginning of the file
+  void map(const std::string &fname, size_t offset);
+
+  // parse the ".npy" header, return its size
+  size_t header(const char *data, size_t bytes);
+
+  // check the type description, normalize the byte order
+  void check_descr();
+
+  // type description corresponding to "T"
+  template <class T>
+  static std::string descr();
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,287 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_MINIMIZE_CPP
+#define GOOSEDEM_MINIMIZE_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "Minimize.h"
+
+// =================================================================================================
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool lineSearch(Geometry &g, const ColD &M, const MatD &X_n, const ColD &d, double E_n,
+  const ColD &G_n, double dx_max, double c2, double &s, double &E, ColD &G)
+{
+  // slope along the search direction
+  double slope = G_n.dot(d);
+
+  // maximum step length: limit the displacement
+  double dmax = d.cwiseAbs().maxCoeff();
+
+  if ( dmax == 0.0 ) return false;
+
+  double smax = dx_max / dmax;
+
+  s = std::min(s, smax);
+
+  // margin for the round-off of the energy
+  double margin = 16. * std::numeric_limits<double>::epsilon() * std::abs(E_n);
+
+  // bracket [lo, hi] of the step length, with the slope at its ends
+  double lo = 0.0, slope_lo = slope;
+  double hi = std::numeric_limits<double>::infinity(), slope_hi = 0.0;
+
+  // iterate: each trial step reuses the force evaluation for the energy and the slope
+  for ( size_t i = 0 ; i < 64 ; ++i )
+  {
+    // - evaluate energy and gradient at the trial step
+    g.set_x(MatD( X_n + g.asParticle(ColD( s * d )) ));
+
+    E = g.potential();
+    G = - M.cwiseProduct( g.solve() );
+
+    double ds = G.dot(d);
+
+    // - update the bracket: too far (sufficient decrease violated, or past the minimum) ...
+    if ( ! std::isfinite(E) || ! std::isfinite(ds) || E > E_n + 1.e-4 * s * slope + margin )
+    {
+      hi = s; slope_hi = std::isfinite(ds) ? ds : 0.0;
+    }
+    // - ... sufficient decrease and curvature condition: accept ...
+    else if ( std::abs(ds) <= c2 * std::abs(slope) || ( ds < 0.0 && s >= smax ) )
+    {
+      return true;
+    }
+    // - ... past the minimum ...
+    else if ( ds > 0.0 )
+    {
+      hi = s; slope_hi = ds;
+    }
+    // - ... not far enough
+    else
+    {
+      lo = s; slope_lo = ds;
+    }
+
+    // - new trial: extrapolate, or interpolate the slope (secant) within the bracket
+    if ( ! std::isfinite(hi) )
+    {
+      s = std::min( 2. * s, smax );
+    }
+    else
+    {
+      double t = .5 * ( lo + hi );
+
+      if ( slope_hi > slope_lo ) t = lo - slope_lo * ( hi - lo ) / ( slope_hi - slope_lo );
+
+      s = std::max( lo + .1 * ( hi - lo ), std::min( hi - .1 * ( hi - lo ), t ) );
+    }
+  }
+
+  // no step satisfying the curvature condition found: use the lower end of the bracket (that
+  // satisfies the sufficient decrease condition)
+  if ( lo > 0.0 )
+  {
+    s = lo;
+    g.set_x(MatD( X_n + g.asParticle(ColD( s * d )) ));
+    E = g.potential();
+    G = - M.cwiseProduct( g.solve() );
+    return true;
+  }
+
+  // no step found: reset positions
+  g.set_x(X_n);
+
+  return false;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t quasiStaticLBFGS(Geometry &g, double tol, double dx_max, size_t m)
+{
+  // reset residuals
+  g.reset();
+
+  // ground the system
+  g.set_v(ColD( ColD::Zero(g.dofs_v().size()) ));
+  g.set_a(ColD( ColD::Zero(g.dofs_a().size()) ));
+
+  // DOF masses, the gradient is "- M * A"
+  ColD M = g.dofs_m();
+
+  // energy and gradient
+  double E_n = g.potential();
+  ColD   G_n = - M.cwiseProduct( g.solve() );
+  double E;
+  ColD   G;
+
+  // curvature condition of the line search
+  double c2 = 0.9;
+
+  // history of position and gradient updates (circular)
+  std::vector<ColD>   S(m);
+  std::vector<ColD>   Y(m);
+  std::vector<double> rho(m);
+  std::vector<double> alpha(m);
+  size_t nhist = 0; // number of stored updates
+  size_t ihist = 0; // position of the next update
+
+  // zero-initialize iteration counter
+  size_t iiter = 0;
+
+  // loop until convergence
+  while ( true )
+  {
+    // - search direction, two-loop recursion: "d = - H * G"
+    ColD d = - G_n;
+
+    for ( size_t k = 0 ; k < nhist ; ++k )
+    {
+      size_t i = ( ihist + m - 1 - k ) % m;
+      alpha[i] = rho[i] * S[i].dot(d);
+      d -= alpha[i] * Y[i];
+    }
+
+    if ( nhist > 0 )
+    {
+      size_t i = ( ihist + m - 1 ) % m;
+      d *= S[i].dot(Y[i]) / Y[i].squaredNorm();
+    }
+
+    for ( size_t k = nhist ; k-- > 0 ; )
+    {
+      size_t i = ( ihist + m - 1 - k ) % m;
+      d += S[i] * ( alpha[i] - rho[i] * Y[i].dot(d) );
+    }
+
+    // - restart if "d" is not a descent direction
+    if ( ! ( G_n.dot(d) < 0.0 ) ) { d = - G_n; nhist = 0; }
+
+    // - line search (unit step for a quasi-Newton direction), restart once if it fails
+    MatD   X_n = g.x();
+    double s   = 1.0;
+
+    if ( ! lineSearch(g, M, X_n, d, E_n, G_n, dx_max, c2, s, E, G) )
+    {
+      if ( nhist == 0 )
+        throw std::runtime_error("GooseDEM::quasiStaticLBFGS: line search failed");
+
+      d = - G_n; nhist = 0; s = 1.0;
+
+      if ( ! lineSearch(g, M, X_n, d, E_n, G_n, dx_max, c2, s, E, G) )
+        throw std::runtime_error("GooseDEM::quasiStaticLBFGS: line search failed");
+    }
+
+    // - store the update (only if the curvature condition is satisfied)
+    ColD dX = s * d;
+    ColD dG = G - G_n;
+
+    if ( dX.dot(dG) > 0.0 )
+    {
+      S  [ihist] = dX;
+      Y  [ihist] = dG;
+      rho[ihist] = 1. / dX.dot(dG);
+      ihist = ( ihist + 1 ) % m;
+      nhist = std::min( nhist + 1, m );
+    }
+
+    // - update energy and gradient
+    E_n = E;
+    G_n = G;
+
+    // - update iteration counter
+    iiter++;
+
+    // - check for convergence
+    if ( g.stop(tol) ) return iiter;
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t quasiStaticCG(Geometry &g, double tol, double dx_max)
+{
+  // reset residuals
+  g.reset();
+
+  // ground the system
+  g.set_v(ColD( ColD::Zero(g.dofs_v().size()) ));
+  g.set_a(ColD( ColD::Zero(g.dofs_a().size()) ));
+
+  // DOF masses, the gradient is "- M * A"
+  ColD M = g.dofs_m();
+
+  // energy and gradient
+  double E_n = g.potential();
+  ColD   G_n = - M.cwiseProduct( g.solve() );
+  double E;
+  ColD   G;
+
+  // curvature condition of the line search (close to an exact line search)
+  double c2 = 0.1;
+
+  // search direction, and the step length
+  ColD   d = - G_n;
+  double s = std::numeric_limits<double>::infinity();
+
+  // zero-initialize iteration counter
+  size_t iiter = 0;
+
+  // loop until convergence
+  while ( true )
+  {
+    // - line search, restart with steepest descent if it fails
+    MatD   X_n   = g.x();
+    double slope = G_n.dot(d);
+
+    if ( ! lineSearch(g, M, X_n, d, E_n, G_n, dx_max, c2, s, E, G) )
+    {
+      if ( d == - G_n )
+        throw std::runtime_error("GooseDEM::quasiStaticCG: line search failed");
+
+      d = - G_n;
+      s = std::numeric_limits<double>::infinity();
+      slope = G_n.dot(d);
+
+      if ( ! lineSearch(g, M, X_n, d, E_n, G_n, dx_max, c2, s, E, G) )
+        throw std::runtime_error("GooseDEM::quasiStaticCG: line search failed");
+    }
+
+    // - Polak-Ribiere (non-negative) update of the search direction
+    double beta = std::max( 0.0, G.dot( G - G_n ) / G_n.squaredNorm() );
+
+    d = - G + beta * d;
+
+    // - restart if "d" is not a descent direction
+    if ( ! ( G.dot(d) < 0.0 ) ) d = - G;
+
+    // - initial step length for the next line search: same first-order change of the energy
+    s *= slope / G.dot(d);
+
+    // - update energy and gradient
+    E_n = E;
+    G_n = G;
+
+    // - update iteration counter
+    iiter++;
+
+    // - check for convergence
+    if ( g.stop(tol) ) return iiter;
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
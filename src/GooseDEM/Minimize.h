@@ -0,0 +1,51 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_MINIMIZE_H
+#define GOOSEDEM_MINIMIZE_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include "GooseDEM.h"
+
+// =================================================================================================
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+// Minimize the total potential energy "geometry.potential()" w.r.t. the positions of the free DOFs
+// (the prescribed DOFs are kept in place). The gradient follows from the force "M * solve()", the
+// system is grounded first (zero velocity) such that the dashpots do not contribute. Each iteration
+// performs a line search in which the displacement of a DOF is limited to "dx_max"; every trial
+// step evaluates the energy and the force, and the force at the accepted step is reused for the
+// next search direction. Convergence is checked using "geometry.stop(tol)", as for
+// "quasiStaticVelocityVerlet". Returns the number of iterations.
+
+// limited memory BFGS, storing the last "m" updates
+inline size_t quasiStaticLBFGS(Geometry &geometry, double tol, double dx_max, size_t m=10);
+
+// Polak-Ribiere nonlinear conjugate gradient (restarted when the direction is not a descent
+// direction)
+inline size_t quasiStaticCG(Geometry &geometry, double tol, double dx_max);
+
+// line search along the DOF-direction "d", starting from the positions "X_n" [N, ndim] with energy
+// "E_n" and gradient "G_n" [ndof], that finds a step satisfying the (strong) Wolfe conditions: a
+// sufficient decrease of the energy, and a decrease of the magnitude of the slope by a factor "c2".
+// The bracket of the step is refined by interpolating the slope (secant). On input "s" is the
+// initial step length, on output the accepted step length; "E" and "G" are the energy and gradient
+// at the accepted step. Returns false if no step with a sufficient decrease was found (the positions
+// are then reset).
+inline bool lineSearch(Geometry &geometry, const ColD &M, const MatD &X_n, const ColD &d,
+  double E_n, const ColD &G_n, double dx_max, double c2, double &s, double &E, ColD &G);
+
+// -------------------------------------------------------------------------------------------------
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
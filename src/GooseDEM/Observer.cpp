@@ -0,0 +1,179 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_OBSERVER_CPP
+#define GOOSEDEM_OBSERVER_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "Observer.h"
+
+// =================================================================================================
+
+namespace GooseDEM {
+
+// ------------------------------------------ constructor ------------------------------------------
+
+inline Observer::Observer(size_t stride) : m_stride(stride), m_step(0), m_t(0.0)
+{
+  assert( m_stride > 0 );
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Observer::Observer(const std::vector<Observable> &observable, size_t stride) :
+  m_observable(observable), m_stride(stride), m_step(0), m_t(0.0)
+{
+  assert( m_stride > 0 );
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Observer::add(Observable observable)
+{
+  m_observable.push_back(observable);
+
+  clear();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Observer::observe(const Geometry &g, const ColD &V, const ColD &A, double dt)
+{
+  if ( advance(dt) ) record(g, V, A);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool Observer::advance(double dt)
+{
+  // update time step and time
+  m_step += 1;
+  m_t    += dt;
+
+  // record only every "stride" time steps
+  return m_step % m_stride == 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Observer::record(const Geometry &g, const ColD &V, const ColD &A)
+{
+  // check which observables are needed
+  bool dofs = false;
+
+  for ( auto &o : m_observable )
+    if ( o == Observable::kinetic || o == Observable::vmax || o == Observable::residual )
+      dofs = true;
+
+  // reductions over the DOFs, in a single pass
+  double kinetic  = 0.0;
+  double vmax     = 0.0;
+  double residual = 0.0;
+
+  if ( dofs )
+  {
+    ColD M = g.dofs_m();
+
+    assert( M.size() == V.size() );
+    assert( M.size() == A.size() );
+
+    for ( auto i = 0 ; i < M.size() ; ++i )
+    {
+      kinetic += M(i) * V(i) * V(i);
+      vmax     = std::max(vmax    , std::abs(V(i)));
+      residual = std::max(residual, std::abs(M(i) * A(i)));
+    }
+
+    kinetic *= .5;
+  }
+
+  // record
+  m_rstep.push_back(m_step);
+  m_rtime.push_back(m_t);
+
+  for ( auto &o : m_observable )
+  {
+    switch ( o )
+    {
+      case Observable::kinetic : m_data.push_back(kinetic ); break;
+      case Observable::vmax    : m_data.push_back(vmax    ); break;
+      case Observable::residual: m_data.push_back(residual); break;
+      case Observable::potential: m_data.push_back(g.potential()); break;
+      case Observable::coordination:
+      {
+        ColS C = g.coordination();
+        m_data.push_back(C.size() > 0 ? static_cast<double>(C.sum()) / C.size() : 0.0);
+        break;
+      }
+    }
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::vector<Observable> Observer::observables() const
+{
+  return m_observable;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Observer::size() const
+{
+  return m_rstep.size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Observer::step() const
+{
+  return Eigen::Map<const Eigen::Matrix<size_t,Eigen::Dynamic,1>>(m_rstep.data(), m_rstep.size())
+    .cast<Index>();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Observer::time() const
+{
+  return Eigen::Map<const ColD>(m_rtime.data(), m_rtime.size());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Observer::data() const
+{
+  return Eigen::Map<const MatD>(m_data.data(), m_rstep.size(), m_observable.size());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Observer::data(Observable observable) const
+{
+  auto it = std::find(m_observable.begin(), m_observable.end(), observable);
+
+  if ( it == m_observable.end() )
+    throw std::runtime_error("GooseDEM::Observer: observable not recorded");
+
+  return data().col(it - m_observable.begin());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Observer::clear()
+{
+  m_rstep.clear();
+  m_rtime.clear();
+  m_data .clear();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
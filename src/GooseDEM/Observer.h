@@ -0,0 +1,93 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_OBSERVER_H
+#define GOOSEDEM_OBSERVER_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include "GooseDEM.h"
+
+// =================================================================================================
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+// quantities that can be recorded by an "Observer"
+enum class Observable
+{
+  kinetic,      // kinetic energy "1/2 V^T M V"
+  vmax,         // largest absolute DOF-velocity
+  residual,     // largest absolute residual force "Fint - Fext" on the free DOFs (i.e. "|M A|")
+  coordination, // mean coordination of the particles
+  potential     // potential energy (evaluates all interactions)
+};
+
+// -------------------------------------------------------------------------------------------------
+
+// Time series of observables, recorded by the time integrators (that take an optional observer).
+// The observables are computed in a single pass over the DOF-velocities and DOF-accelerations at
+// the end of the time step (without fetching particle vectors), every "stride" time steps.
+
+class Observer
+{
+private:
+
+  // observables, and the stride (in time steps) at which they are recorded
+  std::vector<Observable> m_observable;
+  size_t m_stride;
+
+  // current time step and time
+  size_t m_step;
+  double m_t;
+
+  // records: time step, time, and the observables (row-major) [nrecord, nobservable]
+  std::vector<size_t> m_rstep;
+  std::vector<double> m_rtime;
+  std::vector<double> m_data;
+
+public:
+
+  // constructor
+  Observer(size_t stride=1);
+  Observer(const std::vector<Observable> &observable, size_t stride=1);
+
+  // append an observable (clears the records)
+  void add(Observable observable);
+
+  // process a time step "dt", record if needed: the DOF-velocities and DOF-accelerations at the
+  // end of the time step are those that the integrator has just set
+  void observe(const Geometry &geometry, const ColD &V, const ColD &A, double dt);
+
+  // the same in two parts, such that the DOF-velocities are only assembled if they are recorded:
+  // advance a time step "dt" and return if it has to be recorded, record the current time step
+  bool advance(double dt);
+  void record(const Geometry &geometry, const ColD &V, const ColD &A);
+
+  // return the observables, and the number of records
+  std::vector<Observable> observables() const;
+  size_t size() const;
+
+  // return the records: time step [nrecord], time [nrecord], all observables [nrecord, nobservable]
+  // or one observable [nrecord]
+  ColS step() const;
+  ColD time() const;
+  MatD data() const;
+  ColD data(Observable observable) const;
+
+  // clear the records (the time step and time continue)
+  void clear();
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+} // namespace ...
+
+// =================================================================================================
+
+#endif
@@ -0,0 +1,309 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_PAIRSTATE_CPP
+#define GOOSEDEM_PAIRSTATE_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "PairState.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+inline PairState::PairState() : PairState(std::make_shared<const Topology>())
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline PairState::PairState(std::shared_ptr<const Topology> topology) :
+  m_topology(std::move(topology)), m_typed(false)
+{
+  // check input
+  assert( m_topology );
+
+  // all pairs are active
+  m_active = ColB::Ones(m_topology->size());
+  m_degree = m_topology->degree();
+  m_ndead  = 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline PairState::PairState(std::shared_ptr<const Topology> topology, ColT type) :
+  m_topology(std::move(topology)), m_type(std::move(type)), m_typed(true)
+{
+  // check input
+  assert( m_topology );
+  assert( static_cast<Eigen::Index>(m_topology->size()) == m_type.size() );
+
+  // all pairs are active
+  m_active = ColB::Ones(m_topology->size());
+  m_degree = m_topology->degree();
+  m_ndead  = 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const std::shared_ptr<const Topology>& PairState::topology() const
+{
+  return m_topology;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const MatS& PairState::particles() const
+{
+  return m_topology->particles();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t PairState::size() const
+{
+  return m_topology->size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool PairState::typed() const
+{
+  return m_typed;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColT& PairState::type() const
+{
+  return m_type;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool PairState::check(Eigen::Index size) const
+{
+  if ( ! m_typed ) return static_cast<Eigen::Index>(m_topology->size()) == size;
+
+  return m_type.size() == 0 || m_type.maxCoeff() < size;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t PairState::param(size_t p) const
+{
+  if ( ! m_typed ) return p;
+
+  return m_type(p);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD PairState::expand(const ColD &data) const
+{
+  if ( ! m_typed ) return data;
+
+  ColD out(m_type.size());
+
+  for ( auto p = 0 ; p < m_type.size() ; ++p ) out(p) = data(m_type(p));
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool PairState::active(size_t p) const
+{
+  return m_active(p);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColB& PairState::active() const
+{
+  return m_active;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t PairState::ndead() const
+{
+  return m_ndead;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS PairState::coordination(size_t N) const
+{
+  // zero-initialize coordination per particle
+  ColS C = ColS::Zero(N);
+
+  // copy the number of active neighbors
+  auto n = std::min(N, m_topology->N());
+
+  C.head(n) = m_degree.head(n);
+
+  return C;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void PairState::deactivate(const ColS &index)
+{
+  // particle pairs
+  const MatS &pairs = m_topology->particles();
+
+  for ( auto k = 0 ; k < index.size() ; ++k )
+  {
+    // - pair number
+    auto p = index(k);
+    // - skip pairs that are already broken
+    if ( ! m_active(p) ) continue;
+    // - deactivate
+    m_active(p) = 0;
+    m_ndead    += 1;
+    // - update the coordination
+    m_degree(pairs(p,0)) -= 1;
+    m_degree(pairs(p,1)) -= 1;
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS PairState::compact()
+{
+  // nothing to do
+  if ( m_ndead == 0 ) return ColS::LinSpaced(m_topology->size(), 0, m_topology->size()-1);
+
+  // particle pairs
+  const MatS &pairs = m_topology->particles();
+
+  // former index of the active pairs
+  ColS index(m_topology->size() - m_ndead);
+
+  for ( size_t p = 0, k = 0 ; p < m_topology->size() ; ++p )
+    if ( m_active(p) )
+      index(k++) = p;
+
+  // new topology, with the same number of particles
+  MatS particles(index.size(), 2);
+
+  for ( auto k = 0 ; k < index.size() ; ++k )
+    particles.row(k) = pairs.row(index(k));
+
+  compact(std::make_shared<const Topology>(std::move(particles), m_topology->N()), index);
+
+  return index;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void PairState::compact(std::shared_ptr<const Topology> topology, const ColS &index)
+{
+  // check input
+  assert( topology );
+  assert( static_cast<Eigen::Index>(topology->size()) == index.size() );
+
+  // select the type (the table is kept) and the active state
+  if ( m_typed ) m_type = select(m_type, index);
+
+  ColB active = select(m_active, index);
+
+  // store the topology
+  m_topology = std::move(topology);
+  m_own      = nullptr;
+  m_active   = ColB::Ones(m_topology->size());
+  m_degree   = m_topology->degree();
+  m_ndead    = 0;
+
+  // deactivate the pairs that are broken in this model, but that are present in the new topology
+  ColS dead(m_topology->size());
+  size_t ndead = 0;
+
+  for ( auto k = 0 ; k < active.size() ; ++k )
+    if ( ! active(k) )
+      dead(ndead++) = k;
+
+  deactivate(ColS( dead.head(ndead) ));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void PairState::compact(ColD &data, const ColS &index) const
+{
+  if ( ! m_typed ) data = select(data, index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void PairState::append(const MatS &particles, const ColT &type)
+{
+  // number of new pairs
+  auto m = particles.rows();
+
+  // check input
+  assert( ! m_typed || type.size() == m );
+
+  // types
+  if ( m_typed ) join(m_type, type);
+
+  // topology: copy it once if it is (or might be) used elsewhere, append in place otherwise (the
+  // topology is referenced by "m_own" and "m_topology")
+  if ( ! m_own || m_own.use_count() > 2 )
+    m_own = std::make_shared<Topology>(*m_topology);
+
+  m_own->append(particles);
+
+  m_topology = m_own;
+
+  // the new pairs are active
+  join(m_active, ColB( ColB::Ones(m) ));
+
+  // update the coordination (the number of particles may have increased)
+  auto N = static_cast<Eigen::Index>(m_topology->N());
+
+  if ( m_degree.size() < N ) join(m_degree, ColS( ColS::Zero(N - m_degree.size()) ));
+
+  for ( auto p = 0 ; p < m ; ++p )
+  {
+    m_degree(particles(p,0)) += 1;
+    m_degree(particles(p,1)) += 1;
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <class T>
+inline void PairState::join(T &data, const T &values)
+{
+  auto n = data.size();
+
+  data.conservativeResize(n + values.size());
+  data.tail(values.size()) = values;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <class T>
+inline T PairState::select(const T &data, const ColS &index)
+{
+  T out(index.size());
+
+  for ( auto k = 0 ; k < index.size() ; ++k ) out(k) = data(index(k));
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,108 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_PAIRSTATE_H
+#define GOOSEDEM_PAIRSTATE_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include "GooseDEM.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+// State of the pairs of a pair model (e.g. "Spring"): the topology (that can be shared between
+// models), the type of each pair (if the parameters are stored in a table), and the active (1) or
+// broken (0) state of each pair with the resulting coordination. It implements the bookkeeping of
+// the parameter table and of breaking and compacting the pairs, that is common to all pair models.
+
+class PairState
+{
+private:
+
+  std::shared_ptr<const Topology> m_topology; // particle pairs [n, 2] (can be shared)
+  std::shared_ptr<Topology>       m_own;      // the topology, if it was created by "append"
+  ColT m_type;      // type of each pair [n] (empty if "m_typed" is false)
+  bool m_typed;     // parameters stored per type (true) or per pair (false)
+
+  ColB   m_active;  // active state                   [n]
+  ColS   m_degree;  // number of active pairs         [N]
+  size_t m_ndead;   // number of broken pairs
+
+public:
+
+  // constructor: all pairs are active, the parameters are stored per pair (without "type"), or per
+  // type (with the type of each pair "type" [n]; also if there are no pairs)
+  PairState();
+  PairState(std::shared_ptr<const Topology> topology);
+  PairState(std::shared_ptr<const Topology> topology, ColT type);
+
+  // return the topology, the particle pairs [n, 2], and the number of pairs
+  const std::shared_ptr<const Topology>& topology() const;
+  const MatS& particles() const;
+  size_t size() const;
+
+  // return if the parameters are stored per type, and the type of each pair [n] (by reference)
+  bool        typed() const;
+  const ColT& type()  const;
+
+  // check the size of a parameter: [ntype] (containing all types) or [n]
+  bool check(Eigen::Index size) const;
+
+  // return the row of the parameters of pair "p"
+  size_t param(size_t p) const;
+
+  // return a parameter per pair [n] (also if it is stored per type)
+  ColD expand(const ColD &data) const;
+
+  // return the active state of pair "p", of each pair [n], and the number of broken pairs
+  bool        active(size_t p) const;
+  const ColB& active()         const;
+  size_t      ndead()          const;
+
+  // return the coordination of each of "N" particles (the number of active pairs)
+  ColS coordination(size_t N) const;
+
+  // deactivate (break) pairs, by their index [m] (pairs that are already broken are skipped)
+  void deactivate(const ColS &index);
+
+  // remove the broken pairs (in a new topology), return the former index of each remaining pair
+  ColS compact();
+
+  // replace the topology by one that contains the former pairs "index", the pairs keep their state
+  // and type
+  void compact(std::shared_ptr<const Topology> topology, const ColS &index);
+
+  // keep the former pairs "index" of a parameter, after "compact" (the table is kept as is)
+  void compact(ColD &data, const ColS &index) const;
+
+  // append pairs [m, 2], with their type [m] if the parameters are stored per type (ignored
+  // otherwise); the new pairs are active. A topology that is shared (with other models or copies)
+  // is copied once, after which it is no longer shared and the pairs are appended in place: a
+  // sequence of appends costs linear time in the number of appended pairs, the adjacency of the
+  // topology is rebuilt once on first use.
+  void append(const MatS &particles, const ColT &type=ColT());
+
+  // append the values of the new pairs [m] to a per-pair array [n] (in place, if possible)
+  template <class T>
+  static void join(T &data, const T &values);
+
+  // return a subset "index" of a per-pair array
+  template <class T>
+  static T select(const T &data, const ColS &index);
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,271 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_PARALLEL_CPP
+#define GOOSEDEM_PARALLEL_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "Parallel.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t default_nthread()
+{
+  return std::max(static_cast<size_t>(std::thread::hardware_concurrency()), static_cast<size_t>(1));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::atomic<bool>& deterministic_mode()
+{
+#ifdef GOOSEDEM_DETERMINISTIC
+  static std::atomic<bool> mode(true);
+#else
+  static std::atomic<bool> mode(false);
+#endif
+
+  return mode;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool deterministic()
+{
+  return deterministic_mode();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void set_deterministic(bool deterministic)
+{
+  deterministic_mode() = deterministic;
+}
+
+// ------------------------------------------ constructor ------------------------------------------
+
+inline ThreadPool::ThreadPool(size_t nthread) :
+  m_task(nullptr), m_active(0), m_remaining(0), m_batch(0), m_stop(false), m_busy(false)
+{
+  nthread = std::max(nthread, static_cast<size_t>(1));
+
+  // allocate the queues
+  for ( size_t t = 0 ; t < nthread ; ++t ) m_queue.emplace_back(new Queue);
+
+  // start the threads (the calling thread is thread 0)
+  for ( size_t t = 1 ; t < nthread ; ++t ) m_thread.emplace_back(&ThreadPool::worker, this, t);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ThreadPool::~ThreadPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+
+  m_cv_start.notify_all();
+
+  for ( auto &thread : m_thread ) thread.join();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t ThreadPool::size() const
+{
+  return m_queue.size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void ThreadPool::run(size_t n, const std::function<void(size_t)> &task, size_t nthread)
+{
+  // number of participating threads
+  if ( nthread == 0 ) nthread = size();
+
+  nthread = std::min(std::min(nthread, size()), n);
+
+  // serial: nothing to distribute, or the pool is busy
+  if ( nthread <= 1 || m_busy.exchange(true) )
+  {
+    for ( size_t i = 0 ; i < n ; ++i ) task(i);
+
+    return;
+  }
+
+  // set the batch (before filling the queues, from which a thread may take a task at any time)
+  m_task      = &task;
+  m_error     = nullptr;
+  m_remaining = n;
+
+  // fill the queues with contiguous blocks of tasks
+  for ( size_t t = 0 ; t < nthread ; ++t )
+  {
+    std::lock_guard<std::mutex> lock(m_queue[t]->mutex);
+
+    for ( size_t i = t * n / nthread ; i < (t+1) * n / nthread ; ++i )
+      m_queue[t]->tasks.push_back(i);
+  }
+
+  // start the batch
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_active  = nthread;
+    m_batch  += 1;
+  }
+
+  m_cv_start.notify_all();
+
+  // take part
+  execute(0);
+
+  // wait for the tasks that are being evaluated by other threads
+  {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_cv_done.wait(lock, [this]{ return m_remaining == 0; });
+  }
+
+  std::exception_ptr error = m_error;
+
+  m_busy = false;
+
+  if ( error ) std::rethrow_exception(error);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void ThreadPool::worker(size_t id)
+{
+  size_t batch = 0;
+
+  while ( true )
+  {
+    // wait for a new batch
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+
+      m_cv_start.wait(lock, [&]{ return m_stop || m_batch != batch; });
+
+      if ( m_stop ) return;
+
+      batch = m_batch;
+
+      if ( id >= m_active ) continue;
+    }
+
+    execute(id);
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void ThreadPool::execute(size_t id)
+{
+  size_t i;
+
+  while ( take(id, i) )
+  {
+    try
+    {
+      (*m_task)(i);
+    }
+    catch (...)
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if ( ! m_error ) m_error = std::current_exception();
+    }
+
+    // last task: signal that the batch is finished
+    if ( --m_remaining == 0 )
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_cv_done.notify_all();
+    }
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool ThreadPool::take(size_t id, size_t &i)
+{
+  // own queue: from the front
+  {
+    std::lock_guard<std::mutex> lock(m_queue[id]->mutex);
+
+    if ( ! m_queue[id]->tasks.empty() )
+    {
+      i = m_queue[id]->tasks.front();
+      m_queue[id]->tasks.pop_front();
+      return true;
+    }
+  }
+
+  // other queues: steal from the back
+  for ( size_t t = 1 ; t < m_queue.size() ; ++t )
+  {
+    Queue &queue = *m_queue[(id + t) % m_queue.size()];
+
+    std::lock_guard<std::mutex> lock(queue.mutex);
+
+    if ( ! queue.tasks.empty() )
+    {
+      i = queue.tasks.back();
+      queue.tasks.pop_back();
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ThreadPool& pool()
+{
+  static ThreadPool pool(default_nthread());
+
+  return pool;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void parallel_for(size_t n, size_t nthread, const std::function<void(size_t)> &task)
+{
+  // serial: nothing to distribute
+  if ( nthread <= 1 || n <= 1 )
+  {
+    for ( size_t i = 0 ; i < n ; ++i ) task(i);
+
+    return;
+  }
+
+  pool().run(n, task, nthread);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void parallel_range(size_t n, size_t grain, size_t nthread,
+  const std::function<void(size_t,size_t)> &task)
+{
+  grain = std::max(grain, static_cast<size_t>(1));
+
+  size_t nrange = ( n + grain - 1 ) / grain;
+
+  parallel_for(nrange, nthread, [&](size_t i){ task(i * grain, std::min((i+1) * grain, n)); });
+}
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,127 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_PARALLEL_H
+#define GOOSEDEM_PARALLEL_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include "GooseDEM.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+// default number of threads: the number of hardware threads
+inline size_t default_nthread();
+
+// Reductions in deterministic mode are evaluated in a fixed order, such that the result is bitwise
+// reproducible between runs and independent of the number of threads; in fast mode (the default,
+// unless compiled with "GOOSEDEM_DETERMINISTIC") partial results may be combined in the order in
+// which the threads finish. This concerns "Vector::assembleDofs" (when compiled with OpenMP), all
+// other reductions are always deterministic. Deterministic mode uses the inverse DOF map that each
+// "Vector" stores ("N*ndim + ndof + 1" indices, see "Vector.h"), and gathers the entries of each
+// DOF instead of reducing per-thread buffers: on one thread it costs about as much as fast mode, it
+// does not allocate per-thread buffers, and it does not use more threads than "ndof / 16384".
+inline bool deterministic();
+inline void set_deterministic(bool deterministic);
+
+// -------------------------------------------------------------------------------------------------
+
+// Pool of persistent threads that evaluates a batch of independent tasks "task(i)", "i = 0, ...,
+// n-1". Each thread has its own queue, which is filled with a contiguous block of tasks. A thread
+// takes tasks from the front of its own queue, and once that is empty steals from the back of the
+// queues of the other threads, such that unequal tasks are balanced without a central queue. The
+// calling thread takes part (as thread 0). The first exception thrown by a task is re-thrown after
+// the batch is finished. A batch that is started while the pool is busy (from another thread, or
+// from within a task) is evaluated serially by the calling thread.
+
+class ThreadPool
+{
+private:
+
+  // queue of tasks of one thread
+  struct Queue
+  {
+    std::deque<size_t> tasks;
+    std::mutex         mutex;
+  };
+
+  // threads and their queues
+  std::vector<std::thread>            m_thread;
+  std::vector<std::unique_ptr<Queue>> m_queue;
+
+  // current batch: task, number of participating threads, number of unfinished tasks, first error
+  const std::function<void(size_t)> *m_task;
+  size_t                             m_active;
+  std::atomic<size_t>                m_remaining;
+  std::exception_ptr                 m_error;
+
+  // synchronization
+  std::mutex              m_mutex;
+  std::condition_variable m_cv_start; // a batch is started (or the pool is stopped)
+  std::condition_variable m_cv_done;  // a batch is finished
+  size_t                  m_batch;    // number of started batches
+  bool                    m_stop;
+  std::atomic<bool>       m_busy;
+
+public:
+
+  // constructor: start "nthread-1" threads (the calling thread is the remaining one)
+  ThreadPool(size_t nthread=default_nthread());
+
+  // the pool cannot be copied
+  ThreadPool(const ThreadPool &) = delete;
+  ThreadPool& operator=(const ThreadPool &) = delete;
+
+  // destructor: stop the threads
+  ~ThreadPool();
+
+  // number of threads (including the calling thread)
+  size_t size() const;
+
+  // evaluate "task(i)" for "i = 0, ..., n-1" using at most "nthread" threads (0: all), return when
+  // all tasks are finished
+  void run(size_t n, const std::function<void(size_t)> &task, size_t nthread=0);
+
+private:
+
+  // thread "id": wait for batches and evaluate them
+  void worker(size_t id);
+
+  // thread "id": evaluate tasks until there are none left (in its own queue or in any other)
+  void execute(size_t id);
+
+  // take a task from the front of the own queue, or from the back of the queue of another thread
+  bool take(size_t id, size_t &i);
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+// shared thread pool, with the default number of threads (started on first use)
+inline ThreadPool& pool();
+
+// evaluate "task(i)" for "i = 0, ..., n-1" on the shared thread pool, using at most "nthread"
+// threads. The tasks must be independent: to obtain a result that does not depend on the number of
+// threads, let each task write to its own buffer and reduce the buffers (after the call) in a fixed
+// order.
+inline void parallel_for(size_t n, size_t nthread, const std::function<void(size_t)> &task);
+
+// evaluate "task(begin, end)" for consecutive ranges of (at most) "grain" items that together cover
+// "0, ..., n-1", on the shared thread pool using at most "nthread" threads
+inline void parallel_range(size_t n, size_t grain, size_t nthread,
+  const std::function<void(size_t,size_t)> &task);
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,182 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_PERIODIC_CPP
+#define GOOSEDEM_PERIODIC_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "Periodic.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// ------------------------------------------ constructor ------------------------------------------
+
+inline Periodic::Periodic() : m_ndim(0)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Periodic::Periodic(const ColD &L)
+{
+  // extract dimensions
+  m_ndim = static_cast<size_t>(L.size());
+
+  // orthogonal box
+  m_H    = L.asDiagonal();
+  m_Hdot = MatD::Zero(m_ndim, m_ndim);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Periodic::Periodic(const MatD &H) : m_H(H)
+{
+  // extract dimensions
+  m_ndim = static_cast<size_t>(m_H.rows());
+
+  // check input
+  assert( m_H.rows() == m_H.cols() );
+  assert( m_H.isUpperTriangular() );
+
+  // zero-initialize rate
+  m_Hdot = MatD::Zero(m_ndim, m_ndim);
+
+  // reduce the tilt
+  reduce();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Periodic::set_shearRate(double gammadot, size_t i, size_t j)
+{
+  // check input
+  assert( i < j      );
+  assert( j < m_ndim );
+
+  // set rate of tilt
+  m_Hdot(i,j) = gammadot * m_H(j,j);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Periodic::set_shear(double gamma, size_t i, size_t j)
+{
+  // check input
+  assert( i < j      );
+  assert( j < m_ndim );
+
+  // set tilt
+  m_H(i,j) = gamma * m_H(j,j);
+
+  // reduce the tilt
+  reduce();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Periodic::timestep(double dt)
+{
+  // non-periodic: nothing to do
+  if ( m_ndim == 0 ) return;
+
+  // update tilt
+  m_H += dt * m_Hdot;
+
+  // reduce the tilt
+  reduce();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Periodic::reduce()
+{
+  // loop over all off-diagonal components
+  for ( size_t j = 1 ; j < m_ndim ; ++j )
+  {
+    for ( size_t i = j ; i-- > 0 ; )
+    {
+      // - number of box lengths by which the tilt exceeds half a box length
+      double n = std::round( m_H(i,j) / m_H(i,i) );
+      // - subtract box vector "i" (yields an equivalent lattice)
+      if ( n != 0.0 )
+      {
+        m_H   .col(j) -= n * m_H   .col(i);
+        m_Hdot.col(j) -= n * m_Hdot.col(i);
+      }
+    }
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Periodic::H() const
+{
+  return m_H;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Periodic::Hdot() const
+{
+  return m_Hdot;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline bool Periodic::periodic() const
+{
+  return m_ndim > 0;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Periodic::minimumImage(double *dx) const
+{
+  // loop over the box vectors, starting with the last: it is the only one with a component in the
+  // last direction (upper-triangular)
+  for ( size_t d = m_ndim ; d-- > 0 ; )
+  {
+    // - number of images to shift
+    double s = std::round( dx[d] / m_H(d,d) );
+    // - apply shift
+    if ( s != 0.0 )
+      for ( size_t i = 0 ; i <= d ; ++i )
+        dx[i] -= s * m_H(i,d);
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Periodic::minimumImage(double *dx, double *dv) const
+{
+  // loop over the box vectors, starting with the last: it is the only one with a component in the
+  // last direction (upper-triangular)
+  for ( size_t d = m_ndim ; d-- > 0 ; )
+  {
+    // - number of images to shift
+    double s = std::round( dx[d] / m_H(d,d) );
+    // - apply shift, the image moves with the box
+    if ( s != 0.0 )
+    {
+      for ( size_t i = 0 ; i <= d ; ++i )
+      {
+        dx[i] -= s * m_H   (i,d);
+        dv[i] -= s * m_Hdot(i,d);
+      }
+    }
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
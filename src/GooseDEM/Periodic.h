@@ -0,0 +1,76 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_PERIODIC_H
+#define GOOSEDEM_PERIODIC_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include "GooseDEM.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+// Periodic box, spanned by the columns of an upper-triangular matrix "H" [ndim, ndim]. The diagonal
+// contains the box lengths, the off-diagonal components the tilt (triclinic/sheared box). Lees-
+// Edwards boundary conditions correspond to a tilt that changes in time at a constant rate: the
+// images in direction "j" are then shifted by "gamma * H(j,j)" in direction "i".
+// A default constructed box is not periodic (all operations are then the identity).
+
+class Periodic
+{
+private:
+
+  MatD   m_H;    // box vectors (columns)                   [ndim, ndim]
+  MatD   m_Hdot; // rate of change of the box vectors        [ndim, ndim]
+  size_t m_ndim; // number of spatial dimensions (0: not periodic)
+
+public:
+
+  // constructor
+  Periodic();
+  Periodic(const ColD &L); // orthogonal box, with edge lengths "L" [ndim]
+  Periodic(const MatD &H); // triclinic box [ndim, ndim]
+
+  // Lees-Edwards: set the shear rate, such that the tilt "H(i,j)" increases by "gammadot*H(j,j)"
+  // per unit of time
+  void set_shearRate(double gammadot, size_t i=0, size_t j=1);
+
+  // Lees-Edwards: set the shear, i.e. set the tilt "H(i,j) = gamma*H(j,j)"
+  void set_shear(double gamma, size_t i=0, size_t j=1);
+
+  // process time-step: update the tilt, at the set shear rate
+  void timestep(double dt);
+
+  // return box vectors (and their rate of change) [ndim, ndim]
+  MatD H()    const;
+  MatD Hdot() const;
+
+  // check if the box is periodic
+  bool periodic() const;
+
+  // apply the minimum image convention to a position difference [ndim] (modified in-place), and
+  // correct the velocity difference [ndim] for the relative motion of the images (Lees-Edwards)
+  void minimumImage(double *dx) const;
+  void minimumImage(double *dx, double *dv) const;
+
+private:
+
+  // reduce the tilt to the range [-H(i,i)/2, +H(i,i)/2] (the lattice of images is unchanged)
+  void reduce();
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
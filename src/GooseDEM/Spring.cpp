@@ -17,24 +17,95 @@ namespace GooseDEM {
 
 // -------------------------------------------------------------------------------------------------
 
-inline Spring::Spring(const MatS &particles, const ColD &k, const ColD &D0) :
-  m_particles(particles), m_k(k), m_D0(D0)
+inline Spring::Spring() : Spring(std::make_shared<const Topology>(), ColD(), ColD())
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Spring::Spring(MatS particles, ColD k, ColD D0) :
+  Spring(std::make_shared<const Topology>(std::move(particles)), std::move(k), std::move(D0))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Spring::Spring(std::shared_ptr<const Topology> topology, ColD k, ColD D0) :
+  Spring(PairState(std::move(topology)), std::move(k), std::move(D0))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Spring::Spring(MatS particles, ColT type, ColD k, ColD D0) :
+  Spring(std::make_shared<const Topology>(std::move(particles)), std::move(type), std::move(k),
+    std::move(D0))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Spring::Spring(std::shared_ptr<const Topology> topology, ColT type, ColD k, ColD D0) :
+  Spring(PairState(std::move(topology), std::move(type)), std::move(k), std::move(D0))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Spring::Spring(PairState state, ColD k, ColD D0) :
+  m_state(std::move(state)), m_k(std::move(k)), m_D0(std::move(D0))
 {
   // check input
-  assert( m_particles.rows() == m_k .size() );
-  assert( m_particles.rows() == m_D0.size() );
+  assert( m_state.check(m_k.size()) );
+  assert( m_k.size() == m_D0.size() );
+
+  // unbreakable
+  m_eps_c = ColD::Constant(m_state.size(), std::numeric_limits<double>::infinity());
+  m_rupture = false;
 }
 
 // -------------------------------------------------------------------------------------------------
 
 inline MatD Spring::force(const MatD &X) const
 {
-  // dimensions
-  auto n    = X.rows(); // number of particles
-  auto ndim = X.cols(); // number of dimensions
+  return force(X, Periodic());
+}
+
+// -------------------------------------------------------------------------------------------------
 
+inline MatD Spring::force(const MatD &X, const Periodic &box) const
+{
   // zero-initialize force per particle
-  MatD F = MatD::Zero(n, ndim);
+  MatD F = MatD::Zero(X.rows(), X.cols());
+
+  // all springs
+  add_force(X, box, m_state.size(), [](size_t k){ return k; }, F);
+
+  return F;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Spring::force(const MatD &X, const Periodic &box, const Index *index, size_t m,
+  MatD &F) const
+{
+  // check input
+  assert( F.rows() == X.rows() );
+  assert( F.cols() == X.cols() );
+
+  add_force(X, box, m, [index](size_t k){ return index[k]; }, F);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <class P>
+inline void Spring::add_force(const MatD &X, const Periodic &box, size_t m, P pair, MatD &F) const
+{
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // number of dimensions
+  auto ndim = X.cols();
 
   // local variables
   cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
@@ -43,21 +114,27 @@ inline MatD Spring::force(const MatD &X) const
   cppmat::cartesian::vector<double> f (ndim); // force vector
   double D; // distance in 'local coordinates'
 
-  // loop over all springs
-  for ( auto p = 0 ; p < m_particles.rows() ; ++p )
+  // loop over the springs
+  for ( size_t k = 0 ; k < m ; ++k )
   {
+    // - pair number, skip broken pairs
+    auto p = pair(k);
+    if ( ! m_state.active(p) ) continue;
     // - extract particle numbers
-    auto i = m_particles(p,0);
-    auto j = m_particles(p,1);
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
     // - copy the particles' positions to the vectors "xi" and "xj"
     std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
     std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
     // - compute the position difference vector
     dx = xj - xi;
+    // - apply periodicity
+    box.minimumImage(dx.data());
     // - compute the current length
     D = dx.length();
     // - compute the force vector, by comparing to the spring's relaxed length
-    f = m_k(p) * (D - m_D0(p)) * dx/D;
+    auto t = m_state.param(p);
+    f = m_k(t) * (D - m_D0(t)) * dx/D;
     // - assemble the force to the particles
     for ( auto d = 0 ; d < ndim ; ++d )
     {
@@ -65,29 +142,391 @@ inline MatD Spring::force(const MatD &X) const
       F(j,d) -= f(d);
     }
   }
-
-  return F;
 }
 
 // -------------------------------------------------------------------------------------------------
 
 inline ColS Spring::coordination(const MatD &X) const
 {
-  // zero-initialize coordination per particle
-  ColS C = ColS::Zero(X.rows());
+  return m_state.coordination(X.rows());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Spring::potential(const MatD &X) const
+{
+  return potential(X, Periodic());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Spring::potential(const MatD &X, const Periodic &box) const
+{
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // dimensions
+  auto ndim = X.cols(); // number of dimensions
+
+  // zero-initialize energy per spring
+  ColD V = ColD::Zero(pairs.rows());
+
+  // local variables
+  cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
+  cppmat::cartesian::vector<double> xj(ndim); // position of particle "j"
+  cppmat::cartesian::vector<double> dx(ndim); // position difference
+  double D; // distance in 'local coordinates'
+
+  // loop over all springs
+  for ( auto p = 0 ; p < pairs.rows() ; ++p )
+  {
+    // - skip broken pairs
+    if ( ! m_state.active(p) ) continue;
+    // - extract particle numbers
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
+    // - copy the particles' positions to the vectors "xi" and "xj"
+    std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
+    std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
+    // - compute the position difference vector
+    dx = xj - xi;
+    // - apply periodicity
+    box.minimumImage(dx.data());
+    // - compute the current length
+    D = dx.length();
+    // - compute the energy
+    auto t = m_state.param(p);
+    V(p) = .5 * m_k(t) * std::pow(D - m_D0(t), 2.);
+  }
+
+  return V;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Spring::stiffness(const MatD &X, const Periodic &box) const
+{
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // dimensions
+  auto ndim = X.cols(); // number of dimensions
+
+  // zero-initialize stiffness per spring
+  ColD K = ColD::Zero(pairs.rows());
+
+  // local variables
+  cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
+  cppmat::cartesian::vector<double> xj(ndim); // position of particle "j"
+  cppmat::cartesian::vector<double> dx(ndim); // position difference
+  double D; // distance in 'local coordinates'
+
+  // loop over all springs
+  for ( auto p = 0 ; p < pairs.rows() ; ++p )
+  {
+    // - skip broken pairs
+    if ( ! m_state.active(p) ) continue;
+    // - extract particle numbers
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
+    // - copy the particles' positions to the vectors "xi" and "xj"
+    std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
+    std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
+    // - compute the position difference vector
+    dx = xj - xi;
+    // - apply periodicity
+    box.minimumImage(dx.data());
+    // - compute the current length
+    D = dx.length();
+    // - largest of the axial stiffness and the geometric (transverse) stiffness
+    auto t = m_state.param(p);
+    K(p) = std::max(std::abs(m_k(t)), std::abs(m_k(t) * (D - m_D0(t)) / D));
+  }
+
+  return K;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Spring::tangent(const MatD &X, const Periodic &box) const
+{
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // dimensions
+  auto ndim = X.cols(); // number of dimensions
+
+  // zero-initialize tangent per spring
+  MatD K = MatD::Zero(pairs.rows(), ndim*ndim);
+
+  // local variables
+  cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
+  cppmat::cartesian::vector<double> xj(ndim); // position of particle "j"
+  cppmat::cartesian::vector<double> dx(ndim); // position difference
+  double D;  // distance in 'local coordinates'
+  double ka; // axial stiffness
+  double kt; // geometric (transverse) stiffness
+
+  // loop over all springs
+  for ( auto p = 0 ; p < pairs.rows() ; ++p )
+  {
+    // - skip broken pairs
+    if ( ! m_state.active(p) ) continue;
+    // - extract particle numbers
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
+    // - copy the particles' positions to the vectors "xi" and "xj"
+    std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
+    std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
+    // - compute the position difference vector
+    dx = xj - xi;
+    // - apply periodicity
+    box.minimumImage(dx.data());
+    // - compute the current length
+    D = dx.length();
+    // - axial and geometric stiffness
+    auto t = m_state.param(p);
+    ka = m_k(t);
+    kt = m_k(t) * (D - m_D0(t)) / D;
+    // - tangent: ka * n n + kt * (I - n n), with "n = dx/D"
+    for ( auto a = 0 ; a < ndim ; ++a )
+    {
+      for ( auto b = 0 ; b < ndim ; ++b )
+      {
+        K(p,a*ndim+b) = (ka - kt) * dx(a) * dx(b) / (D*D);
+        if ( a == b ) K(p,a*ndim+b) += kt;
+      }
+    }
+  }
+
+  return K;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Spring::deactivate(const ColS &index)
+{
+  m_state.deactivate(index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColB& Spring::active() const
+{
+  return m_state.active();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Spring::ndead() const
+{
+  return m_state.ndead();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Spring::compact()
+{
+  // nothing to do
+  if ( m_state.ndead() == 0 ) return m_state.compact();
+
+  // remove the broken pairs, keep the parameters of the remaining pairs
+  ColS index = m_state.compact();
+
+  compact_param(index);
+
+  return index;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Spring::compact(std::shared_ptr<const Topology> topology, const ColS &index)
+{
+  m_state.compact(std::move(topology), index);
+
+  compact_param(index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Spring::set_rupture(const ColD &eps_c)
+{
+  // check input
+  assert( static_cast<Eigen::Index>(m_state.size()) == eps_c.size() );
+
+  // store
+  m_eps_c = eps_c;
+
+  // enable the check only if some pairs can break
+  m_rupture = ( eps_c.array() < std::numeric_limits<double>::infinity() ).any();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Spring::rupture(const MatD &X, const Periodic &box)
+{
+  // no pairs can break
+  if ( ! m_rupture ) return ColS();
+
+  // particle pairs
+  const MatS &pairs = m_state.particles();
+
+  // dimensions
+  auto ndim = X.cols(); // number of dimensions
+
+  // list of pairs that break
+  ColS   broken(pairs.rows());
+  size_t nbroken = 0;
+
+  // local variables
+  cppmat::cartesian::vector<double> xi(ndim); // position of particle "i"
+  cppmat::cartesian::vector<double> xj(ndim); // position of particle "j"
+  cppmat::cartesian::vector<double> dx(ndim); // position difference
+  double D;                                   // distance in 'local coordinates'
 
   // loop over all springs
-  for ( auto p = 0 ; p < m_particles.rows() ; ++p )
+  for ( auto p = 0 ; p < pairs.rows() ; ++p )
   {
+    // - skip broken pairs
+    if ( ! m_state.active(p) ) continue;
     // - extract particle numbers
-    auto i = m_particles(p,0);
-    auto j = m_particles(p,1);
-    // - add to coordination
-    C(i) += 1;
-    C(j) += 1;
+    auto i = pairs(p,0);
+    auto j = pairs(p,1);
+    // - copy the particles' positions to the vectors "xi" and "xj"
+    std::copy(X.data()+i*ndim, X.data()+(i+1)*ndim, xi.data());
+    std::copy(X.data()+j*ndim, X.data()+(j+1)*ndim, xj.data());
+    // - compute the position difference vector
+    dx = xj - xi;
+    // - apply periodicity
+    box.minimumImage(dx.data());
+    // - compute the current length
+    D = dx.length();
+    // - check the critical strain
+    auto t = m_state.param(p);
+    if ( ( D - m_D0(t) ) / m_D0(t) > m_eps_c(p) ) broken(nbroken++) = p;
+  }
+
+  // deactivate
+  broken.conservativeResize(nbroken);
+
+  deactivate(broken);
+
+  return broken;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Spring::eps_c() const
+{
+  return m_eps_c;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline std::shared_ptr<const Topology> Spring::topology() const
+{
+  return m_state.topology();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const MatS& Spring::particles() const
+{
+  return m_state.particles();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Spring::k() const
+{
+  return m_state.expand(m_k);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Spring::D0() const
+{
+  return m_state.expand(m_D0);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColT Spring::type() const
+{
+  return m_state.type();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Spring::ntype() const
+{
+  if ( ! m_state.typed() ) return 0;
+
+  return m_k.size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Spring::append(const MatS &particles, const ColD &k, const ColD &D0, const ColD &eps_c)
+{
+  // check input
+  assert( ! m_state.typed() );
+  assert( k.size() == particles.rows() );
+  assert( D0.size() == particles.rows() );
+
+  // pairs, parameters, breaking criterion
+  m_state.append(particles);
+
+  PairState::join(m_k , k);
+  PairState::join(m_D0, D0);
+
+  append_rupture(eps_c, particles.rows());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Spring::append(const MatS &particles, const ColT &type, const ColD &eps_c)
+{
+  // check input
+  assert( m_state.typed() );
+  assert( type.size() == particles.rows() );
+  assert( type.size() == 0 || type.maxCoeff() < m_k.size() );
+
+  // pairs, breaking criterion (the table is kept)
+  m_state.append(particles, type);
+
+  append_rupture(eps_c, particles.rows());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Spring::compact_param(const ColS &index)
+{
+  m_state.compact(m_k , index);
+  m_state.compact(m_D0, index);
+
+  m_eps_c = PairState::select(m_eps_c, index);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Spring::append_rupture(const ColD &eps_c, Eigen::Index m)
+{
+  // unbreakable
+  if ( eps_c.size() == 0 )
+  {
+    ColD inf = ColD::Constant(m, std::numeric_limits<double>::infinity());
+    PairState::join(m_eps_c, inf);
+    return;
   }
 
-  return C;
+  // check input
+  assert( eps_c.size() == m );
+
+  // store, enable the check if some of the new pairs can break
+  PairState::join(m_eps_c, eps_c);
+
+  m_rupture = m_rupture || ( eps_c.array() < std::numeric_limits<double>::infinity() ).any();
 }
 
 // -------------------------------------------------------------------------------------------------
@@ -21,22 +21,104 @@ class Spring
 {
 private:
 
-  MatS m_particles; // particle pairs   [n, ndim]
-  ColD m_k;         // stiffness        [n]
-  ColD m_D0;        // relaxed length   [n]
+  PairState m_state; // topology (can be shared), type and active state of each pair
+  ColD m_k;           // stiffness        [n] or [ntype]
+  ColD m_D0;          // relaxed length   [n] or [ntype]
+
+  // breaking criterion
+  ColD m_eps_c;     // critical strain  [n]
+  bool m_rupture;   // true if some pairs can break
 
 public:
 
-  // constructor
-  Spring(){};
-  Spring(const MatS &particles, const ColD &k, const ColD &D0);
+  // constructor (the topology can be shared between models)
+  Spring();
+  Spring(MatS particles, ColD k, ColD D0);
+  Spring(std::shared_ptr<const Topology> topology, ColD k, ColD D0);
+
+  // constructor with a parameter table: the parameters are given per type [ntype], each pair
+  // refers to a row of the table by its type [n]
+  Spring(MatS particles, ColT type, ColD k, ColD D0);
+  Spring(std::shared_ptr<const Topology> topology, ColT type, ColD k, ColD D0);
 
   // compute the force on each particle (the output could contain many zero rows)
   MatD force(const MatD &x) const;
+  MatD force(const MatD &x, const Periodic &box) const;
+
+  // add the force of the pairs "index" [m] to the force on each particle "F" [N, ndim]; pairs that
+  // do not share a particle (e.g. of one color, see "Topology::colored") can be added concurrently
+  void force(const MatD &x, const Periodic &box, const Index *index, size_t m, MatD &F) const;
 
   // compute the coordination of each particle
   ColS coordination(const MatD &X) const;
 
+  // compute the potential energy of each spring [n]
+  ColD potential(const MatD &x) const;
+  ColD potential(const MatD &x, const Periodic &box) const;
+
+  // compute the stiffness of each spring [n]: the largest eigenvalue (in absolute value) of the
+  // tangent of the force w.r.t. the position difference
+  ColD stiffness(const MatD &x, const Periodic &box) const;
+
+  // compute the tangent of the force on the first particle w.r.t. the position difference, for
+  // each spring [n, ndim*ndim] (row-major blocks)
+  MatD tangent(const MatD &x, const Periodic &box) const;
+
+  // deactivate (break) pairs, by their index [m]
+  void deactivate(const ColS &index);
+
+  // return the active (1) or broken (0) state of each pair [n], and the number of broken pairs
+  const ColB& active() const;
+  size_t      ndead()  const;
+
+  // remove the broken pairs (in a new topology), return the former index of each remaining pair
+  ColS compact();
+
+  // replace the topology by one that contains the former pairs "index" (e.g. the topology that
+  // resulted from "compact" of another model that shared the topology)
+  void compact(std::shared_ptr<const Topology> topology, const ColS &index);
+
+  // append pairs [m, 2] (e.g. the interactions of inserted particles), with their parameters [m],
+  // or their type [m] if the parameters are stored per type, and (optionally) their critical strain
+  // [m] (default: unbreakable); the topology is no longer shared with other models
+  void append(const MatS &particles, const ColD &k, const ColD &D0, const ColD &eps_c=ColD());
+  void append(const MatS &particles, const ColT &type, const ColD &eps_c=ColD());
+
+  // set the critical strain "(D - D0) / D0" at which a pair breaks [n] (default: infinite,
+  // unbreakable)
+  void set_rupture(const ColD &eps_c);
+
+  // break the pairs for which the critical strain is exceeded (at the given positions), return
+  // their index
+  ColS rupture(const MatD &x, const Periodic &box);
+
+  // return parameters (per pair [n], also if they are stored per type)
+  std::shared_ptr<const Topology> topology() const;
+  const MatS& particles() const;
+  ColD k()         const;
+  ColD D0()        const;
+  ColD eps_c()     const;
+
+  // return the type of each pair [n] and the number of types (both empty if the parameters are
+  // stored per pair)
+  ColT   type()  const;
+  size_t ntype() const;
+
+private:
+
+  // constructor from the state of the pairs (per pair or per type)
+  Spring(PairState state, ColD k, ColD D0);
+
+  // add the force of the pairs "pair(0), ..., pair(m-1)" to "F" [N, ndim]
+  template <class P>
+  void add_force(const MatD &x, const Periodic &box, size_t m, P pair, MatD &F) const;
+
+  // keep the parameters of the former pairs "index" (after compacting the pairs)
+  void compact_param(const ColS &index);
+
+  // append the critical strain of "m" new pairs (empty: unbreakable)
+  void append_rupture(const ColD &eps_c, Eigen::Index m);
+
 };
 
 // -------------------------------------------------------------------------------------------------
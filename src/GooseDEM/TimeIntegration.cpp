@@ -17,8 +17,56 @@ namespace GooseDEM {
 
 // -------------------------------------------------------------------------------------------------
 
-inline void Verlet(Geometry &g, double dt)
+inline void Verlet(Geometry &g, double dt, Observer *observer)
 {
+  Verlet<Geometry>(g, dt, observer);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <class G>
+inline void Verlet(G &g, double dt, Observer *observer)
+{
+  // mutable views of the state: update in-place
+
+  MatD       *px    = g.view_x();
+  MatD       *pv    = g.view_v();
+  MatD       *pa    = g.view_a();
+  const MatS *pdofs = g.view_dofs();
+
+  if ( px && pv && pa && pdofs )
+  {
+    // - flat storage
+    double       *x    = px->data();
+    double       *v    = pv->data();
+    double       *a    = pa->data();
+    const Index  *dofs = pdofs->data();
+    size_t        n    = static_cast<size_t>(px->size());
+    // - split the loops in ranges, evaluated on the shared thread pool (if large enough)
+    size_t grain   = 16384;
+    size_t nthread = n >= 2 * grain ? default_nthread() : 1;
+    // - new position
+    double c = 0.5 * std::pow(dt,2.);
+    parallel_range(n, grain, nthread, [&](size_t begin, size_t end)
+    {
+      for ( size_t k = begin ; k < end ; ++k ) x[k] = x[k] + dt * v[k] + c * a[k];
+    });
+    // - new acceleration and velocity
+    ColD A = g.solve();
+    parallel_range(n, grain, nthread, [&](size_t begin, size_t end)
+    {
+      for ( size_t k = begin ; k < end ; ++k )
+      {
+        v[k] = v[k] + .5 * dt * ( a[k] + A(dofs[k]) );
+        a[k] = A(dofs[k]);
+      }
+    });
+    // - finalize
+    g.timestep(dt);
+    if ( observer && observer->advance(dt) ) observer->record(g, g.dofs_v(), A);
+    return;
+  }
+
   // history
 
   ColD V;
@@ -38,17 +86,82 @@ inline void Verlet(Geometry &g, double dt)
 
   // new velocity
 
-  g.set_v(ColD( V_n + .5 * dt * ( A_n + A ) ));
+  V = V_n + .5 * dt * ( A_n + A );
+
+  g.set_v(V);
 
   // finalize
 
   g.timestep(dt);
+
+  if ( observer ) observer->observe(g, V, A, dt);
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline void velocityVerlet(Geometry &g, double dt)
+inline void velocityVerlet(Geometry &g, double dt, Observer *observer)
 {
+  velocityVerlet<Geometry>(g, dt, observer);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <class G>
+inline void velocityVerlet(G &g, double dt, Observer *observer)
+{
+  // mutable views of the state: update in-place
+
+  MatD       *px    = g.view_x();
+  MatD       *pv    = g.view_v();
+  MatD       *pa    = g.view_a();
+  const MatS *pdofs = g.view_dofs();
+
+  if ( px && pv && pa && pdofs )
+  {
+    // - history
+    MatD V_n = *pv;
+    ColD A;
+    // - flat storage
+    double       *x    = px->data();
+    double       *v    = pv->data();
+    double       *a    = pa->data();
+    double       *v_n  = V_n.data();
+    const Index  *dofs = pdofs->data();
+    size_t        n    = static_cast<size_t>(px->size());
+    // - split the loops in ranges, evaluated on the shared thread pool (if large enough)
+    size_t grain   = 16384;
+    size_t nthread = n >= 2 * grain ? default_nthread() : 1;
+    // - new position, estimate new velocity
+    double c = 0.5 * std::pow(dt,2.);
+    parallel_range(n, grain, nthread, [&](size_t begin, size_t end)
+    {
+      for ( size_t k = begin ; k < end ; ++k )
+      {
+        x[k] = x[k] + dt * v[k] + c * a[k];
+        v[k] = v_n[k] + dt * a[k];
+      }
+    });
+    // - new velocity (twice: the velocity dependent forces depend on the estimate)
+    for ( size_t i = 0 ; i < 2 ; ++i )
+    {
+      A = g.solve();
+      parallel_range(n, grain, nthread, [&](size_t begin, size_t end)
+      {
+        for ( size_t k = begin ; k < end ; ++k ) v[k] = v_n[k] + .5 * dt * ( a[k] + A(dofs[k]) );
+      });
+    }
+    // - new acceleration
+    A = g.solve();
+    parallel_range(n, grain, nthread, [&](size_t begin, size_t end)
+    {
+      for ( size_t k = begin ; k < end ; ++k ) a[k] = A(dofs[k]);
+    });
+    // - finalize
+    g.timestep(dt);
+    if ( observer && observer->advance(dt) ) observer->record(g, g.dofs_v(), A);
+    return;
+  }
+
   // history
 
   ColD V;
@@ -72,7 +185,9 @@ inline void velocityVerlet(Geometry &g, double dt)
 
   A = g.solve();
 
-  g.set_v(ColD( V_n + .5 * dt * ( A_n + A ) ));
+  V = V_n + .5 * dt * ( A_n + A );
+
+  g.set_v(V);
 
   // new acceleration
 
@@ -83,15 +198,95 @@ inline void velocityVerlet(Geometry &g, double dt)
   // finalize
 
   g.timestep(dt);
+
+  if ( observer ) observer->observe(g, V, A, dt);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline double adaptiveVelocityVerlet(Geometry &g, double &dt, double dx_max, double dE_max,
+  double growth, double safety, Observer *observer, double *energy)
+{
+  // the energy is only needed for a finite "dE_max"
+
+  bool check_E = std::isfinite(dE_max);
+
+  // history
+
+  ColD V;
+  ColD A;
+  MatD X_n = g.x();
+  ColD V_n = g.dofs_v();
+  ColD A_n = g.dofs_a();
+  double E_n = 0.0;
+  double E   = 0.0;
+
+  if ( check_E ) E_n = ( energy && std::isfinite(*energy) ) ? *energy : g.energy();
+
+  // try time steps, halve the time step after each rejection
+
+  for ( size_t itry = 0 ; itry < 64 ; ++itry )
+  {
+    // - new position
+    g.set_x(MatD( X_n + dt * g.v() + 0.5 * std::pow(dt,2.) * g.a() ));
+    // - estimate new velocity
+    g.set_v(ColD( V_n + dt * A_n ));
+    A = g.solve();
+    g.set_v(ColD( V_n + .5 * dt * ( A_n + A ) ));
+    // - new velocity
+    A = g.solve();
+    g.set_v(ColD( V_n + .5 * dt * ( A_n + A ) ));
+    // - new acceleration
+    A = g.solve();
+    g.set_a(ColD( A ));
+
+    // - check the step
+    MatD X = g.x();
+    V      = g.dofs_v();
+
+    bool accept = X.allFinite() && V.allFinite() && A.allFinite();
+
+    if ( accept ) accept = (X - X_n).cwiseAbs().maxCoeff() <= dx_max;
+    if ( accept && check_E ) { E = g.energy(); accept = E - E_n <= dE_max; }
+
+    // - accept: finalize, and propose the next time step
+    if ( accept )
+    {
+      double out = dt;
+
+      g.timestep(dt);
+
+      if ( observer ) observer->observe(g, V, A, dt);
+
+      if ( energy ) *energy = check_E ? E : std::numeric_limits<double>::quiet_NaN();
+
+      dt = std::min(growth * dt, safety * g.dt_crit());
+
+      return out;
+    }
+
+    // - reject: restore the state, and retry with half the time step
+    g.set_x(X_n);
+    g.set_v(V_n);
+    g.set_a(A_n);
+
+    dt *= .5;
+  }
+
+  throw std::runtime_error("GooseDEM::adaptiveVelocityVerlet: no stable time step found");
 }
 
 // -------------------------------------------------------------------------------------------------
 
-inline size_t quasiStaticVelocityVerlet(Geometry &g, double dt, double tol)
+inline size_t quasiStaticAdaptiveVelocityVerlet(Geometry &g, double &dt, double dx_max, double tol,
+  double growth, double safety, Observer *observer)
 {
   // reset residuals
   g.reset();
 
+  // limit the initial time step to the stability limit (the proposals are limited by each step)
+  dt = std::min(dt, safety * g.dt_crit());
+
   // zero-initialize iteration counter
   size_t iiter = 0;
 
@@ -101,7 +296,8 @@ inline size_t quasiStaticVelocityVerlet(Geometry &g, double dt, double tol)
     // - update iteration counter
     iiter++;
     // - time-step
-    velocityVerlet(g,dt);
+    adaptiveVelocityVerlet(g, dt, dx_max, std::numeric_limits<double>::infinity(), growth, safety,
+      observer);
     // - check for convergence
     if ( g.stop(tol) ) return iiter;
   }
@@ -109,6 +305,364 @@ inline size_t quasiStaticVelocityVerlet(Geometry &g, double dt, double tol)
 
 // -------------------------------------------------------------------------------------------------
 
+inline void RESPA(Geometry &g, double dt, size_t nsub, Observer *observer)
+{
+  // inner time step
+  double h = dt / static_cast<double>(nsub);
+
+  // history
+
+  ColD V;
+  ColD A;
+  ColD V_n;
+  ColD A_n;
+
+  // slow acceleration, half step
+
+  ColD A_slow = g.solve_level(1);
+
+  g.set_v(ColD( g.dofs_v() + .5 * dt * A_slow ));
+
+  // fast acceleration
+
+  ColD A_fast = g.solve_level(0);
+
+  // inner steps: velocity Verlet for the fast interactions
+
+  for ( size_t isub = 0 ; isub < nsub ; ++isub )
+  {
+    // - history
+    V_n = g.dofs_v();
+    A_n = A_fast;
+    // - new position
+    g.set_a(ColD( A_n ));
+    g.set_x(MatD( g.x() + h * g.v() + 0.5 * std::pow(h,2.) * g.a() ));
+    // - estimate new velocity
+    g.set_v(ColD( V_n + h * A_n ));
+    A = g.solve_level(0);
+    g.set_v(ColD( V_n + .5 * h * ( A_n + A ) ));
+    // - new velocity
+    A = g.solve_level(0);
+    g.set_v(ColD( V_n + .5 * h * ( A_n + A ) ));
+    // - new acceleration
+    A_fast = g.solve_level(0);
+    // - finalize
+    g.timestep(h);
+  }
+
+  // slow acceleration, half step
+
+  A_slow = g.solve_level(1);
+
+  V = g.dofs_v() + .5 * dt * A_slow;
+
+  g.set_v(V);
+
+  // new acceleration
+
+  A = A_fast + A_slow;
+
+  g.set_a(A);
+
+  if ( observer ) observer->observe(g, V, A, dt);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t quasiStaticVelocityVerlet(Geometry &g, double dt, double tol, Observer *observer)
+{
+  return quasiStaticVelocityVerlet<Geometry>(g, dt, tol, observer);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <class G>
+inline size_t quasiStaticVelocityVerlet(G &g, double dt, double tol, Observer *observer)
+{
+  // reset residuals
+  g.reset();
+
+  // zero-initialize iteration counter
+  size_t iiter = 0;
+
+  // loop until convergence
+  while ( true )
+  {
+    // - update iteration counter
+    iiter++;
+    // - time-step
+    velocityVerlet(g, dt, observer);
+    // - check for convergence
+    if ( g.stop(tol) ) return iiter;
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t quasiStaticVelocityVerlet(Geometry &g, double dt, Convergence &convergence,
+  Observer *observer)
+{
+  return quasiStaticVelocityVerlet<Geometry>(g, dt, convergence, observer);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <class G>
+inline size_t quasiStaticVelocityVerlet(G &g, double dt, Convergence &convergence,
+  Observer *observer)
+{
+  // reset residuals
+  convergence.reset();
+
+  // DOF masses, and the prescribed DOFs
+  ColD M   = g.dofs_m();
+  ColS iip = g.iip();
+
+  // zero-initialize iteration counter
+  size_t iiter = 0;
+
+  // loop until convergence
+  while ( true )
+  {
+    // - update iteration counter
+    iiter++;
+    // - time-step
+    velocityVerlet(g, dt, observer);
+    // - check for convergence (only every "stride" iterations)
+    if ( ! convergence.check(iiter) ) continue;
+    // - velocity and acceleration of the free DOFs
+    ColD V = g.dofs_v();
+    ColD A = g.dofs_a();
+    for ( auto i = 0 ; i < iip.size() ; ++i ) { V(iip(i)) = 0.0; A(iip(i)) = 0.0; }
+    // - converged: ground the system (the prescribed velocities are kept)
+    if ( convergence.stop(M, V, A, dt) )
+    {
+      g.set_v(ColD( ColD::Zero(V.size()) ));
+      g.set_a(ColD( ColD::Zero(A.size()) ));
+      return iiter;
+    }
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t quasiStaticNewton(Geometry &g, double dt, double tol, size_t max_iter)
+{
+  // reset residuals
+  g.reset();
+
+  // ground the system: the equilibrium is static
+  g.set_v(ColD( ColD::Zero(g.dofs_v().size()) ));
+  g.set_a(ColD( ColD::Zero(g.dofs_a().size()) ));
+
+  // DOF masses, and the mask of free DOFs
+
+  ColD M    = g.dofs_m();
+  ColS iip  = g.iip();
+  ColD free = ColD::Ones(M.size());
+
+  for ( auto i = 0 ; i < iip.size() ; ++i ) free(iip(i)) = 0.0;
+
+  // sparse solver (the sparsity pattern of the tangent does not change during the iterations)
+  Eigen::SimplicialLDLT<SpMatD> solver;
+
+  // residual "Fint - Fext" of the free DOFs (the accelerations of the prescribed DOFs are zero)
+  ColD R = M.cwiseProduct( g.solve() );
+  ColD dX;
+
+  // zero-initialize iteration counter
+  size_t iiter = 0;
+
+  // Newton iterations
+  while ( iiter < max_iter )
+  {
+    // - tangent, the prescribed DOFs are decoupled (with unit diagonal)
+    SpMatD K = g.dofs_K();
+
+    K.prune([&](SpMatD::StorageIndex i, SpMatD::StorageIndex j, double) {
+      return i == j || ( free(i) > 0.0 && free(j) > 0.0 );
+    });
+
+    for ( auto i = 0 ; i < iip.size() ; ++i ) K.coeffRef(iip(i), iip(i)) = 1.0;
+
+    // - factorize, stop if the tangent is singular
+    if ( iiter == 0 ) solver.analyzePattern(K);
+
+    solver.factorize(K);
+
+    if ( solver.info() != Eigen::Success ) break;
+
+    ColD D = solver.vectorD().cwiseAbs();
+
+    if ( D.minCoeff() <= std::numeric_limits<double>::epsilon() * D.maxCoeff() ) break;
+
+    // - Newton direction
+    dX = solver.solve(R);
+
+    if ( ! dX.allFinite() ) break;
+
+    // - line search: halve the update until the residual decreases
+    MatD   X_n = g.x();
+    double r_n = R.norm();
+    double r   = std::numeric_limits<double>::infinity();
+
+    for ( size_t i = 0 ; i < 32 && ! ( r < r_n ) ; ++i )
+    {
+      if ( i > 0 ) dX *= .5;
+
+      g.set_x(MatD( X_n + g.asParticle(dX) ));
+
+      R = M.cwiseProduct( g.solve() );
+      r = R.norm();
+    }
+
+    // - update iteration counter
+    iiter++;
+
+    // - check for convergence
+    if ( g.stop(tol) ) return iiter;
+
+    // - stop if the line search failed
+    if ( ! ( r < r_n ) ) break;
+  }
+
+  // fall back on dynamic relaxation
+  return iiter + quasiStaticVelocityVerlet(g, dt, tol);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Newmark::Newmark(double beta, double gamma) : m_beta(beta), m_gamma(gamma)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Newmark::factorize(const SpMatD &J)
+{
+  // check if the sparsity pattern changed
+  bool analyze = static_cast<size_t>(J.outerSize()) + 1 != m_outer.size() ||
+                 static_cast<size_t>(J.nonZeros())      != m_inner.size();
+
+  if ( ! analyze ) analyze = ! std::equal(m_outer.begin(), m_outer.end(), J.outerIndexPtr());
+  if ( ! analyze ) analyze = ! std::equal(m_inner.begin(), m_inner.end(), J.innerIndexPtr());
+
+  // symbolic factorization
+  if ( analyze )
+  {
+    m_outer.assign(J.outerIndexPtr(), J.outerIndexPtr() + J.outerSize() + 1);
+    m_inner.assign(J.innerIndexPtr(), J.innerIndexPtr() + J.nonZeros());
+
+    m_solver.analyzePattern(J);
+  }
+
+  // numerical factorization
+  m_solver.factorize(J);
+
+  if ( m_solver.info() != Eigen::Success )
+    throw std::runtime_error("GooseDEM::Newmark: factorization of the tangent failed");
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Newmark::step(Geometry &g, double dt, double tol, size_t max_iter,
+  Observer *observer)
+{
+  // history
+
+  MatD X_n  = g.x();
+  MatD Vp_n = g.v();
+  MatD Ap_n = g.a();
+  ColD V_n  = g.dofs_v();
+  ColD A_n  = g.dofs_a();
+
+  // DOF masses, and the mask of free DOFs
+
+  ColD M    = g.dofs_m();
+  ColS iip  = g.iip();
+  ColD free = ColD::Ones(M.size());
+
+  for ( auto i = 0 ; i < iip.size() ; ++i ) free(iip(i)) = 0.0;
+
+  // residual (zero for the prescribed DOFs), after updating the position and velocity consistently
+  // with an estimate of the acceleration
+
+  ColD F;
+
+  auto residual = [&](const ColD &A) -> ColD
+  {
+    g.set_a(ColD( A ));
+    g.set_v(ColD( V_n + dt * ( ( 1. - m_gamma ) * A_n + m_gamma * A ) ));
+    g.set_x(MatD( X_n + dt * Vp_n + std::pow(dt,2.) * ( ( .5 - m_beta ) * Ap_n + m_beta * g.a() ) ));
+
+    F = M.cwiseProduct( g.solve() );
+
+    return free.cwiseProduct( M.cwiseProduct(A) - F );
+  };
+
+  // predictor: constant acceleration
+
+  ColD A = A_n;
+  ColD R = residual(A);
+  ColD dA;
+
+  // Newton iterations
+
+  for ( size_t iiter = 1 ; iiter <= max_iter ; ++iiter )
+  {
+    // - check for convergence
+    double scale = std::max( M.cwiseProduct(A).norm(), F.norm() );
+
+    if ( R.norm() <= tol * scale || scale == 0.0 )
+    {
+      g.timestep(dt);
+
+      if ( observer && observer->advance(dt) )
+        observer->record(g, ColD( V_n + dt * ( ( 1. - m_gamma ) * A_n + m_gamma * A ) ), A);
+
+      return iiter;
+    }
+
+    // - Jacobian, the prescribed DOFs are decoupled (with unit diagonal)
+    SpMatD J = m_beta * std::pow(dt,2.) * g.dofs_K() + m_gamma * dt * g.dofs_C();
+
+    J += SpMatD(M.asDiagonal());
+
+    J.prune([&](SpMatD::StorageIndex i, SpMatD::StorageIndex j, double) {
+      return i == j || ( free(i) > 0.0 && free(j) > 0.0 );
+    });
+
+    for ( auto i = 0 ; i < iip.size() ; ++i ) J.coeffRef(iip(i), iip(i)) = 1.0;
+
+    // - Newton direction
+    factorize(J);
+
+    dA = m_solver.solve(R);
+
+    if ( ! dA.allFinite() )
+      throw std::runtime_error("GooseDEM::Newmark: iterations diverged");
+
+    // - update the acceleration: halve the update while the residual increases (e.g. when the
+    //   update overshoots into a steep part of an interaction potential)
+    double r_n = R.norm();
+
+    for ( size_t i = 0 ; i < 32 ; ++i )
+    {
+      R = residual(ColD( A - dA ));
+
+      if ( R.norm() < r_n ) break;
+
+      dA *= .5;
+    }
+
+    A -= dA;
+  }
+
+  throw std::runtime_error("GooseDEM::Newmark: no convergence, increase \"max_iter\"");
+}
+
+// -------------------------------------------------------------------------------------------------
+
 } // namespace ...
 
 // =================================================================================================
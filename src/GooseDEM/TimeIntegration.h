@@ -17,14 +17,112 @@ namespace GooseDEM {
 
 // -------------------------------------------------------------------------------------------------
 
+// The time integrators take an optional "observer", that is notified at the end of each time step
+// (see "Observer"). For large systems, the in-place updates of the particle vectors are split in
+// ranges that are evaluated on the shared thread pool (see "ThreadPool").
+
 // evaluate one time step
-inline void Verlet(Geometry &geometry, double dt);
+inline void Verlet(Geometry &geometry, double dt, Observer *observer=nullptr);
 
 // evaluate one time step
-inline void velocityVerlet(Geometry &geometry, double dt);
+inline void velocityVerlet(Geometry &geometry, double dt, Observer *observer=nullptr);
 
 // iterate until all particles have come to a rest
-inline size_t quasiStaticVelocityVerlet(Geometry &geometry, double dt, double tol);
+inline size_t quasiStaticVelocityVerlet(Geometry &geometry, double dt, double tol,
+  Observer *observer=nullptr);
+
+// static dispatch: the same integrators, templated over the type of the geometry. These are
+// selected when the concrete type is known, e.g. "velocityVerlet(Ext::Friction::Geometry &, dt)",
+// or explicitly as "velocityVerlet<T>(geometry, dt)". If "T" is "final", the calls to the geometry
+// are resolved at compile time and can be inlined.
+template <class G>
+inline void Verlet(G &geometry, double dt, Observer *observer=nullptr);
+
+template <class G>
+inline void velocityVerlet(G &geometry, double dt, Observer *observer=nullptr);
+
+template <class G>
+inline size_t quasiStaticVelocityVerlet(G &geometry, double dt, double tol,
+  Observer *observer=nullptr);
+
+// iterate until all particles have come to a rest, as checked by "convergence" (instead of by
+// "geometry.stop(tol)"), which is evaluated on the free DOFs every "stride" iterations. Once
+// converged the system is grounded (zero velocity and acceleration of the free DOFs).
+inline size_t quasiStaticVelocityVerlet(Geometry &geometry, double dt, Convergence &convergence,
+  Observer *observer=nullptr);
+
+template <class G>
+inline size_t quasiStaticVelocityVerlet(G &geometry, double dt, Convergence &convergence,
+  Observer *observer=nullptr);
+
+// iterate until static equilibrium using the Newton-Raphson method on the residual "Fint - Fext"
+// of the free DOFs (the prescribed DOFs are kept in place), with a backtracking line search.
+// Convergence is checked using "geometry.stop(tol)", as for "quasiStaticVelocityVerlet". If the
+// tangent "geometry.dofs_K()" is singular, if the line search fails, or if the solution has not
+// converged after "max_iter" iterations, the remainder is solved using
+// "quasiStaticVelocityVerlet(geometry, dt, tol)". Returns the total number of iterations.
+inline size_t quasiStaticNewton(Geometry &geometry, double dt, double tol, size_t max_iter=50);
+
+// evaluate one time step using velocity Verlet with an adaptive time step:
+// - the step is rejected, and retried with half the time step, if the positions or velocities are
+//   not finite, if a particle is displaced by more than "dx_max", or if the energy (if available)
+//   increases by more than "dE_max" (the energy is only evaluated if "dE_max" is finite);
+// - the time step that was used is returned, "dt" is overwritten by the proposal for the next step
+//   (grown by a factor "growth", but never beyond "safety * geometry.dt_crit()"); the first "dt"
+//   should be stable (e.g. "safety * geometry.dt_crit()"), it is not checked against "dt_crit";
+// - "energy" (optional) caches the energy between steps: the energy at the start of the step (NaN
+//   if unknown), overwritten by the energy at the end of the step
+inline double adaptiveVelocityVerlet(Geometry &geometry, double &dt, double dx_max,
+  double dE_max=std::numeric_limits<double>::infinity(), double growth=1.1, double safety=0.9,
+  Observer *observer=nullptr, double *energy=nullptr);
+
+// iterate until all particles have come to a rest, using "adaptiveVelocityVerlet"
+inline size_t quasiStaticAdaptiveVelocityVerlet(Geometry &geometry, double &dt, double dx_max,
+  double tol, double growth=1.1, double safety=0.9, Observer *observer=nullptr);
+
+// evaluate one time step using the r-RESPA multiple-time-stepping scheme: the fast interactions
+// (level 0) are integrated using "nsub" velocity Verlet steps of "dt/nsub", the slow interactions
+// (level 1) are evaluated only at the beginning and the end of the time step "dt"
+inline void RESPA(Geometry &geometry, double dt, size_t nsub, Observer *observer=nullptr);
+
+// -------------------------------------------------------------------------------------------------
+
+// Implicit Newmark time integration (default: average acceleration, unconditionally stable). Each
+// time step the DOF-accelerations are solved by Newton iterations on
+//   R = M A - F(x(A), v(A)),  with  dR/dA = M + gamma dt C + beta dt^2 K
+// using the sparse tangent "dofs_K" and "dofs_C" of the geometry. The symbolic factorization of
+// this matrix is reused for as long as its sparsity pattern does not change. The prescribed DOFs
+// are kept at their prescribed velocity (zero acceleration).
+
+class Newmark
+{
+private:
+
+  // parameters
+  double m_beta;
+  double m_gamma;
+
+  // sparse solver, and the sparsity pattern for which it was analyzed
+  Eigen::SimplicialLDLT<SpMatD> m_solver;
+  std::vector<SpMatD::StorageIndex> m_outer;
+  std::vector<SpMatD::StorageIndex> m_inner;
+
+public:
+
+  // constructor
+  Newmark(double beta=0.25, double gamma=0.5);
+
+  // evaluate one time step; the iterations stop when the residual is smaller than "tol" times the
+  // magnitude of the inertial and internal forces, return the number of iterations
+  size_t step(Geometry &geometry, double dt, double tol=1.e-8, size_t max_iter=50,
+    Observer *observer=nullptr);
+
+private:
+
+  // factorize the (symmetric) Jacobian, (re)analyze the sparsity pattern if needed
+  void factorize(const SpMatD &J);
+
+};
 
 // -------------------------------------------------------------------------------------------------
 
@@ -0,0 +1,340 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_TOPOLOGY_CPP
+#define GOOSEDEM_TOPOLOGY_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "Topology.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// ------------------------------------------ constructor ------------------------------------------
+
+inline Topology::Topology() : Topology(MatS::Zero(0,2))
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Topology::Topology(MatS particles, size_t N) : m_particles(std::move(particles))
+{
+  // check input
+  assert( m_particles.cols() == 2 || m_particles.rows() == 0 );
+
+  // construct adjacency
+  init(N);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Topology::Topology(const int32_t *particles, size_t n, size_t N)
+{
+  // store particle pairs
+  m_particles = convert(particles, n);
+
+  // construct adjacency
+  init(N);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Topology::Topology(const int64_t *particles, size_t n, size_t N)
+{
+  // store particle pairs
+  m_particles = convert(particles, n);
+
+  // construct adjacency
+  init(N);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Topology::Topology(const Topology &topology, const MatS &particles, size_t N) :
+  Topology(topology)
+{
+  append(particles, N);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Topology::append(const MatS &particles, size_t N)
+{
+  // check input
+  assert( particles.cols() == 2 || particles.rows() == 0 );
+
+  // store particle pairs: the existing pairs followed by the new pairs (the storage of a row-major
+  // matrix with a fixed number of columns is extended in place, if possible)
+  auto n = m_particles.rows();
+
+  m_particles.conservativeResize(n + particles.rows(), 2);
+  m_particles.bottomRows(particles.rows()) = particles;
+
+  // update the dimensions, reset the adjacency and the coloring
+  init(std::max(N, m_N));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+template <class T>
+inline MatS Topology::convert(const T *particles, size_t n)
+{
+  // allocate
+  MatS out(n, 2);
+
+  // convert, check that the particle numbers are non-negative and fit in the index type
+  for ( size_t i = 0 ; i < 2*n ; ++i )
+  {
+    if ( particles[i] < 0 )
+      throw std::runtime_error("GooseDEM::Topology: negative particle number");
+
+    if ( static_cast<uint64_t>(particles[i]) > std::numeric_limits<Index>::max() )
+      throw std::runtime_error("GooseDEM::Topology: particle number exceeds the index type");
+
+    out.data()[i] = static_cast<Index>(particles[i]);
+  }
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Topology::init(size_t N)
+{
+  // extract dimensions
+  m_n = static_cast<size_t>(m_particles.rows());
+  m_N = N;
+
+  if ( m_n > 0 ) m_N = std::max(m_N, static_cast<size_t>(m_particles.maxCoeff() + 1));
+
+  // adjacency and coloring: computed on first use
+  m_adjacency = std::make_shared<Adjacency>();
+  m_coloring  = std::make_shared<Coloring>();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const Topology::Adjacency& Topology::adjacency() const
+{
+  std::call_once(m_adjacency->flag, [this]()
+  {
+    Adjacency &out = *m_adjacency;
+
+    // number of neighbors per particle
+    out.degree = ColS::Zero(m_N);
+
+    for ( size_t p = 0 ; p < m_n ; ++p )
+    {
+      out.degree(m_particles(p,0)) += 1;
+      out.degree(m_particles(p,1)) += 1;
+    }
+
+    // offset per particle
+    out.offset = ColS::Zero(m_N+1);
+
+    for ( size_t i = 0 ; i < m_N ; ++i )
+      out.offset(i+1) = out.offset(i) + out.degree(i);
+
+    // neighbors and pairs: fill in the order of the pairs
+    out.neighbor.resize(2*m_n);
+    out.pair    .resize(2*m_n);
+
+    ColS pos = out.offset.head(m_N);
+
+    for ( size_t p = 0 ; p < m_n ; ++p )
+    {
+      // - extract particle numbers
+      auto i = m_particles(p,0);
+      auto j = m_particles(p,1);
+      // - store
+      out.neighbor(pos(i)) = j; out.pair(pos(i)) = p; ++pos(i);
+      out.neighbor(pos(j)) = i; out.pair(pos(j)) = p; ++pos(j);
+    }
+  });
+
+  return *m_adjacency;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const Topology::Coloring& Topology::coloring() const
+{
+  std::call_once(m_coloring->flag, [this]()
+  {
+    Coloring &out = *m_coloring;
+
+    // adjacency
+    const Adjacency &adj = adjacency();
+
+    // greedy coloring of the pairs: the lowest color not used by any other pair of either particle
+    out.color  = ColS::Constant(m_n, m_n);
+    out.ncolor = 0;
+
+    std::vector<size_t> used; // last pair for which a color was found to be used
+
+    for ( size_t p = 0 ; p < m_n ; ++p )
+    {
+      // - mark the colors of the pairs of both particles
+      for ( size_t e = 0 ; e < 2 ; ++e )
+      {
+        auto i = m_particles(p,e);
+
+        for ( size_t k = adj.offset(i) ; k < adj.offset(i+1) ; ++k )
+        {
+          auto c = out.color(adj.pair(k));
+          if ( c < m_n ) { if ( c >= used.size() ) used.resize(c+1, m_n); used[c] = p; }
+        }
+      }
+      // - select the lowest free color
+      size_t c = 0;
+      while ( c < used.size() && used[c] == p ) ++c;
+      // - store
+      out.color(p) = c;
+      out.ncolor   = std::max(out.ncolor, c+1);
+    }
+
+    // pairs per color
+    out.color_offset = ColS::Zero(out.ncolor+1);
+
+    for ( size_t p = 0 ; p < m_n ; ++p )
+      out.color_offset(out.color(p)+1) += 1;
+
+    for ( size_t c = 0 ; c < out.ncolor ; ++c )
+      out.color_offset(c+1) += out.color_offset(c);
+
+    out.colored.resize(m_n);
+
+    ColS cpos = out.color_offset.head(out.ncolor);
+
+    for ( size_t p = 0 ; p < m_n ; ++p )
+      out.colored(cpos(out.color(p))++) = p;
+  });
+
+  return *m_coloring;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Topology::N() const
+{
+  return m_N;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Topology::size() const
+{
+  return m_n;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Topology::ncolor() const
+{
+  return coloring().ncolor;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const MatS& Topology::particles() const
+{
+  return m_particles;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColS& Topology::degree() const
+{
+  return adjacency().degree;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t Topology::degree(size_t i) const
+{
+  return adjacency().degree(i);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Topology::neighbors(size_t i) const
+{
+  const Adjacency &adj = adjacency();
+
+  return adj.neighbor.segment(adj.offset(i), adj.degree(i));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Topology::pairs(size_t i) const
+{
+  const Adjacency &adj = adjacency();
+
+  return adj.pair.segment(adj.offset(i), adj.degree(i));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColS& Topology::offset() const
+{
+  return adjacency().offset;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColS& Topology::neighbor() const
+{
+  return adjacency().neighbor;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColS& Topology::pair() const
+{
+  return adjacency().pair;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColS& Topology::color() const
+{
+  return coloring().color;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Topology::colored(size_t c) const
+{
+  const Coloring &coloring = this->coloring();
+
+  return coloring.colored.segment(coloring.color_offset(c),
+    coloring.color_offset(c+1) - coloring.color_offset(c));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColS& Topology::color_offset() const
+{
+  return coloring().color_offset;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline const ColS& Topology::colored() const
+{
+  return coloring().colored;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,140 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_TOPOLOGY_H
+#define GOOSEDEM_TOPOLOGY_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include "GooseDEM.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+// Graph of interacting particle pairs, that can be shared between the pair models (using a
+// "std::shared_ptr<const Topology>"). Next to the list of pairs it stores, in compressed sparse row
+// (CSR) format, for each particle its neighbors and the corresponding pairs. It furthermore
+// provides a coloring of the pairs: pairs of the same color do not share a particle, and can
+// therefore be assembled in parallel without conflicts (as is done by "Ext::Friction::Geometry" for
+// large models). The adjacency and the coloring are computed on first use (thread-safe), such that
+// topologies that are never colored (e.g. of small models) do not pay for it, and such that pairs
+// can be appended (see "append") without rebuilding the adjacency for each append.
+
+class Topology
+{
+private:
+
+  // pairs
+  MatS m_particles; // particle pairs [n, 2]
+
+  // adjacency (CSR): the neighbors of particle "i" are "neighbor(offset(i)) ...
+  // neighbor(offset(i+1)-1)" (computed on first use, shared by copies of the topology)
+  struct Adjacency
+  {
+    std::once_flag flag;
+    ColS offset;    // offset per particle                [N+1]
+    ColS neighbor;  // neighbor                           [2n]
+    ColS pair;      // pair with the neighbor             [2n]
+    ColS degree;    // number of neighbors per particle   [N]
+  };
+
+  std::shared_ptr<Adjacency> m_adjacency;
+
+  // coloring (CSR): the pairs of color "c" are "colored(color_offset(c)) ... " (computed on first
+  // use, shared by copies of the topology)
+  struct Coloring
+  {
+    std::once_flag flag;
+    ColS   color;        // color per pair     [n]
+    ColS   color_offset; // offset per color   [ncolor+1]
+    ColS   colored;      // pairs, per color   [n]
+    size_t ncolor;       // number of colors
+  };
+
+  std::shared_ptr<Coloring> m_coloring;
+
+  // dimensions
+  size_t m_N;       // number of particles
+  size_t m_n;       // number of pairs
+
+public:
+
+  // constructor: particle pairs [n, 2], the number of particles is at least the largest particle
+  // number plus one; the particle pairs can also be read from (row-major) 32- or 64-bit integer
+  // data, e.g. a memory mapped file, that is converted without intermediate copies
+  Topology();
+  Topology(MatS particles, size_t N=0);
+  Topology(const int32_t *particles, size_t n, size_t N=0);
+  Topology(const int64_t *particles, size_t n, size_t N=0);
+
+  // constructor that appends particle pairs [m, 2] to those of an existing topology (the adjacency
+  // is rebuilt on first use, in linear time)
+  Topology(const Topology &topology, const MatS &particles, size_t N=0);
+
+  // append particle pairs [m, 2], the number of particles is increased to (at least) "N": the pairs
+  // are added to the pair list (that grows in place), the adjacency and the coloring are rebuilt on
+  // first use. A topology that is shared between models must not be modified (see "PairState").
+  void append(const MatS &particles, size_t N=0);
+
+  // return dimensions
+  size_t N()      const; // number of particles
+  size_t size()   const; // number of pairs
+  size_t ncolor() const; // number of colors
+
+  // return the particle pairs [n, 2] (by reference, the topology is immutable)
+  const MatS& particles() const;
+
+  // return the number of neighbors of each particle [N] (by reference)
+  const ColS& degree() const;
+
+  // return the number of neighbors of particle "i"
+  size_t degree(size_t i) const;
+
+  // return the neighbors of particle "i", and the corresponding pairs [degree(i)]
+  ColS neighbors(size_t i) const;
+  ColS pairs(size_t i) const;
+
+  // return the CSR storage of the adjacency (by reference): offset per particle [N+1], neighbor
+  // and pair [2n]
+  const ColS& offset()   const;
+  const ColS& neighbor() const;
+  const ColS& pair()     const;
+
+  // return the color of each pair [n] (by reference), and the pairs of color "c"
+  const ColS& color() const;
+  ColS colored(size_t c) const;
+
+  // return the CSR storage of the coloring (by reference): offset per color [ncolor+1], and pairs
+  // [n]
+  const ColS& color_offset() const;
+  const ColS& colored()      const;
+
+private:
+
+  // convert (row-major) integer data to particle pairs [n, 2]
+  template <class T>
+  static MatS convert(const T *particles, size_t n);
+
+  // set the number of particles (at least the largest particle number plus one), reset the
+  // adjacency and the coloring (they are computed on first use)
+  void init(size_t N);
+
+  // return the adjacency and the coloring, compute them on first use
+  const Adjacency& adjacency() const;
+  const Coloring&  coloring()  const;
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,450 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_TRAJECTORY_CPP
+#define GOOSEDEM_TRAJECTORY_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "Trajectory.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+namespace TrajectoryCodec {
+
+// -------------------------------------------------------------------------------------------------
+
+// file identifier
+static const char magic[] = "GDMTRJ01";
+
+// number of values per block
+static const size_t block = 128;
+
+// -------------------------------------------------------------------------------------------------
+
+// write/read a plain value
+template <class T>
+inline void put(std::vector<char> &out, T value)
+{
+  const char *c = reinterpret_cast<const char*>(&value);
+  out.insert(out.end(), c, c+sizeof(T));
+}
+
+template <class T>
+inline T get(const char *&in)
+{
+  T value;
+  std::copy(in, in+sizeof(T), reinterpret_cast<char*>(&value));
+  in += sizeof(T);
+  return value;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// zig-zag encoding: map signed to unsigned integers, with small absolute values to small values
+inline uint64_t zigzag(int64_t v)
+{
+  return ( static_cast<uint64_t>(v) << 1 ) ^ static_cast<uint64_t>(v >> 63);
+}
+
+inline int64_t unzigzag(uint64_t u)
+{
+  return static_cast<int64_t>( u >> 1 ) ^ -static_cast<int64_t>( u & 1 );
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// pack "n" values to the width of the largest value: width (uint8) followed by the bits
+inline void pack(const uint64_t *in, size_t n, std::vector<char> &out)
+{
+  // width in bits
+  uint64_t m = 0;
+
+  for ( size_t i = 0 ; i < n ; ++i ) m |= in[i];
+
+  unsigned w = 0;
+
+  while ( w < 64 && ( m >> w ) ) ++w;
+
+  out.push_back(static_cast<char>(w));
+
+  if ( w == 0 ) return;
+
+  // pack, least significant bit first
+  uint64_t acc  = 0;
+  unsigned nbit = 0;
+
+  for ( size_t i = 0 ; i < n ; ++i )
+  {
+    acc |= in[i] << nbit;
+
+    if ( nbit + w >= 64 )
+    {
+      put(out, acc);
+      acc  = nbit > 0 ? in[i] >> ( 64 - nbit ) : 0;
+      nbit = nbit + w - 64;
+    }
+    else
+    {
+      nbit += w;
+    }
+  }
+
+  for ( unsigned b = 0 ; b < nbit ; b += 8 ) out.push_back(static_cast<char>( acc >> b ));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+// unpack "n" values, advance the input to the next block
+inline void unpack(const char *&in, size_t n, uint64_t *out)
+{
+  // width in bits
+  unsigned w = static_cast<unsigned char>(*in++);
+
+  if ( w == 0 ) { std::fill(out, out+n, 0); return; }
+
+  // size of the block in bytes
+  size_t bytes = ( n * w + 7 ) / 8;
+
+  const char *end = in + bytes;
+
+  // unpack, least significant bit first
+  uint64_t mask = w == 64 ? ~uint64_t(0) : ( uint64_t(1) << w ) - 1;
+  uint64_t acc  = 0;
+  unsigned have = 0;
+
+  for ( size_t i = 0 ; i < n ; ++i )
+  {
+    if ( have >= w )
+    {
+      out[i] = acc & mask;
+      acc    = w == 64 ? 0 : acc >> w;
+      have  -= w;
+    }
+    else
+    {
+      // - read the next (at most) 8 bytes
+      uint64_t next = 0;
+      size_t   m    = std::min(size_t(8), static_cast<size_t>(end - in));
+      for ( size_t b = 0 ; b < m ; ++b )
+        next |= static_cast<uint64_t>(static_cast<unsigned char>(in[b])) << ( 8 * b );
+      in += m;
+      // - combine with the remaining bits
+      out[i] = ( acc | ( have > 0 ? next << have : next ) ) & mask;
+      acc    = ( w - have ) == 64 ? 0 : next >> ( w - have );
+      have   = 64 - ( w - have );
+    }
+  }
+
+  in = end;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// ------------------------------------------ constructor ------------------------------------------
+
+inline TrajectoryWriter::TrajectoryWriter(const std::string &fname, double precision,
+  size_t keyframe) : m_precision(precision), m_keyframe(keyframe)
+{
+  // check input
+  assert( m_precision > 0. );
+  assert( m_keyframe  > 0  );
+
+  // open the file
+  m_file.open(fname.c_str(), std::ios::binary);
+
+  if ( ! m_file )
+    throw std::runtime_error("GooseDEM::TrajectoryWriter: unable to open '"+fname+"'");
+
+  // write the header
+  std::vector<char> header;
+
+  header.insert(header.end(), TrajectoryCodec::magic, TrajectoryCodec::magic+8);
+
+  TrajectoryCodec::put<double  >(header, m_precision);
+  TrajectoryCodec::put<uint64_t>(header, m_keyframe );
+
+  m_file.write(header.data(), header.size());
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline TrajectoryWriter::~TrajectoryWriter()
+{
+  close();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void TrajectoryWriter::write(const MatD &matrix)
+{
+  using namespace TrajectoryCodec;
+
+  // check the file
+  if ( ! m_file.is_open() ) throw std::runtime_error("GooseDEM::TrajectoryWriter: file not open");
+
+  // dimensions
+  auto rows = matrix.rows();
+  auto cols = matrix.cols();
+  auto n    = static_cast<size_t>(matrix.size());
+
+  // keyframe: at a fixed interval, or if the shape changes
+  bool key = m_index.size() % m_keyframe == 0 || m_prev.rows() != rows || m_prev.cols() != cols;
+
+  // quantize
+  Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> q(rows, cols);
+
+  for ( size_t i = 0 ; i < n ; ++i )
+  {
+    double x = std::round(matrix.data()[i] / m_precision);
+
+    if ( ! ( std::abs(x) < 4.e18 ) )
+      throw std::runtime_error("GooseDEM::TrajectoryWriter: value out of range for the precision");
+
+    q.data()[i] = static_cast<int64_t>(x);
+  }
+
+  // difference with the previous frame, zig-zag encoded
+  std::vector<uint64_t> u(n);
+
+  if ( key ) for ( size_t i = 0 ; i < n ; ++i ) u[i] = zigzag(q.data()[i]);
+  else       for ( size_t i = 0 ; i < n ; ++i ) u[i] = zigzag(q.data()[i] - m_prev.data()[i]);
+
+  // encode
+  std::vector<char> frame;
+
+  put<uint64_t>(frame, 0); // size, set below
+  put<uint8_t >(frame, key ? 1 : 0);
+  put<uint64_t>(frame, static_cast<uint64_t>(rows));
+  put<uint64_t>(frame, static_cast<uint64_t>(cols));
+
+  for ( size_t i = 0 ; i < n ; i += block ) pack(&u[i], std::min(block, n-i), frame);
+
+  uint64_t size = frame.size() - sizeof(uint64_t);
+
+  std::copy(reinterpret_cast<const char*>(&size), reinterpret_cast<const char*>(&size)+8,
+    frame.begin());
+
+  // write
+  m_index.push_back(static_cast<uint64_t>(m_file.tellp()));
+
+  m_file.write(frame.data(), frame.size());
+
+  // store the frame
+  m_prev = std::move(q);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void TrajectoryWriter::write(const ColD &matrix)
+{
+  write(MatD(Eigen::Map<const MatD>(matrix.data(), matrix.size(), 1)));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t TrajectoryWriter::size() const
+{
+  return m_index.size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void TrajectoryWriter::close()
+{
+  if ( ! m_file.is_open() ) return;
+
+  // write the footer
+  std::vector<char> footer;
+
+  footer.insert(footer.end(), TrajectoryCodec::magic, TrajectoryCodec::magic+8);
+
+  for ( auto &offset : m_index ) TrajectoryCodec::put<uint64_t>(footer, offset);
+
+  TrajectoryCodec::put<uint64_t>(footer, m_index.size());
+
+  footer.insert(footer.end(), TrajectoryCodec::magic, TrajectoryCodec::magic+8);
+
+  m_file.write(footer.data(), footer.size());
+
+  m_file.close();
+}
+
+// ------------------------------------------ constructor ------------------------------------------
+
+inline TrajectoryReader::TrajectoryReader(const std::string &fname)
+{
+  using namespace TrajectoryCodec;
+
+  // open the file
+  m_file.open(fname.c_str(), std::ios::binary | std::ios::ate);
+
+  if ( ! m_file )
+    throw std::runtime_error("GooseDEM::TrajectoryReader: unable to open '"+fname+"'");
+
+  uint64_t bytes = static_cast<uint64_t>(m_file.tellg());
+
+  // read the header
+  char header[24];
+
+  m_file.seekg(0);
+
+  if ( bytes < 24 || ! m_file.read(header, 24) || std::string(header, 8) != magic )
+    throw std::runtime_error("GooseDEM::TrajectoryReader: not a trajectory '"+fname+"'");
+
+  const char *h = header + 8;
+
+  m_precision = get<double  >(h);
+  m_keyframe  = static_cast<size_t>(get<uint64_t>(h));
+  m_iprev     = 0;
+
+  // read the footer
+  char trailer[16];
+
+  m_file.seekg(bytes - 16);
+  m_file.read(trailer, 16);
+
+  const char *t = trailer;
+
+  uint64_t nframe = get<uint64_t>(t);
+
+  if ( bytes >= 48 && std::string(t, 8) == magic && nframe <= ( bytes - 48 ) / 8 )
+  {
+    std::vector<char> index(8 * nframe);
+
+    m_file.seekg(bytes - 16 - 8 * nframe);
+    m_file.read(index.data(), index.size());
+
+    const char *in = index.data();
+
+    for ( uint64_t i = 0 ; i < nframe ; ++i ) m_index.push_back(get<uint64_t>(in));
+
+    return;
+  }
+
+  // no footer: reconstruct the index by scanning the frames (a truncated last frame is ignored)
+  m_file.clear();
+
+  for ( uint64_t offset = 24 ; offset + 8 <= bytes ; )
+  {
+    char c[8];
+
+    m_file.seekg(offset);
+    m_file.read(c, 8);
+
+    const char *in = c;
+
+    uint64_t size = get<uint64_t>(in);
+
+    if ( offset + 8 + size > bytes ) break;
+
+    m_index.push_back(offset);
+
+    offset += 8 + size;
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t TrajectoryReader::size() const
+{
+  return m_index.size();
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline double TrajectoryReader::precision() const
+{
+  return m_precision;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline size_t TrajectoryReader::keyframe() const
+{
+  return m_keyframe;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD TrajectoryReader::read(size_t i)
+{
+  // check input
+  if ( i >= m_index.size() ) throw std::runtime_error("GooseDEM::TrajectoryReader: out of range");
+
+  // decode: continue from the last decoded frame, or start at the last keyframe (there is at least
+  // one keyframe every "m_keyframe" frames)
+  size_t start = i - i % m_keyframe;
+
+  if ( m_prev.size() > 0 && m_iprev <= i && m_iprev >= start ) start = m_iprev + 1;
+
+  for ( size_t j = start ; j <= i ; ++j ) decode(j);
+
+  // de-quantize
+  return m_prev.cast<double>() * m_precision;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void TrajectoryReader::decode(size_t i)
+{
+  using namespace TrajectoryCodec;
+
+  // read the frame
+  char c[8];
+
+  m_file.clear();
+  m_file.seekg(m_index[i]);
+  m_file.read(c, 8);
+
+  const char *s = c;
+
+  std::vector<char> frame(get<uint64_t>(s));
+
+  m_file.read(frame.data(), frame.size());
+
+  // decode the frame header
+  const char *in = frame.data();
+
+  bool key  = get<uint8_t >(in) != 0;
+  auto rows = static_cast<Eigen::Index>(get<uint64_t>(in));
+  auto cols = static_cast<Eigen::Index>(get<uint64_t>(in));
+  auto n    = static_cast<size_t>(rows * cols);
+
+  // check that a difference frame follows a frame of the same shape
+  if ( ! key && ( m_prev.rows() != rows || m_prev.cols() != cols ) )
+    throw std::runtime_error("GooseDEM::TrajectoryReader: corrupt frame");
+
+  // unpack
+  std::vector<uint64_t> u(n);
+
+  for ( size_t j = 0 ; j < n ; j += block ) unpack(in, std::min(block, n-j), &u[j]);
+
+  // undo the difference with the previous frame
+  if ( key )
+  {
+    m_prev.resize(rows, cols);
+
+    for ( size_t j = 0 ; j < n ; ++j ) m_prev.data()[j] = unzigzag(u[j]);
+  }
+  else
+  {
+    for ( size_t j = 0 ; j < n ; ++j ) m_prev.data()[j] += unzigzag(u[j]);
+  }
+
+  m_iprev = i;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -0,0 +1,113 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_TRAJECTORY_H
+#define GOOSEDEM_TRAJECTORY_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include "GooseDEM.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+// Compressed trajectory of a (particle) quantity, e.g. the positions. Each frame is quantized to an
+// absolute precision (the error is at most half the precision, and does not accumulate), stored as
+// the difference with the previous frame, and entropy coded by bit-packing blocks of values to the
+// width of the largest (zig-zag encoded) value in the block. Every "keyframe" frames the values are
+// stored without difference, such that a frame is read by decoding at most "keyframe" frames.
+//
+// File layout (little-endian):
+//   header : magic "GDMTRJ01", precision (double), keyframe (uint64)
+//   frame  : size of the rest of the frame in bytes (uint64), keyframe flag (uint8), rows (uint64),
+//            cols (uint64), blocks: width (uint8) followed by the packed bits
+//   footer : magic "GDMTRJ01", offset of each frame (uint64) [nframe], nframe (uint64), magic
+// A file without (complete) footer, e.g. if the writer was not closed, is indexed by scanning the
+// frames. Scanning stops at the first frame that is incomplete (the magic as size is out of range).
+
+class TrajectoryWriter
+{
+private:
+
+  std::ofstream m_file;      // output file
+  double        m_precision; // absolute precision
+  size_t        m_keyframe;  // number of frames between keyframes
+
+  // last frame (quantized)
+  Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> m_prev;
+
+  // offset of each frame
+  std::vector<uint64_t> m_index;
+
+public:
+
+  // constructor: open the file
+  TrajectoryWriter() = default;
+  TrajectoryWriter(const std::string &fname, double precision, size_t keyframe=16);
+
+  // destructor: close the file
+  ~TrajectoryWriter();
+
+  // append a frame
+  void write(const MatD &matrix);
+  void write(const ColD &matrix);
+
+  // number of frames written
+  size_t size() const;
+
+  // write the footer and close the file
+  void close();
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+class TrajectoryReader
+{
+private:
+
+  std::ifstream m_file;      // input file
+  double        m_precision; // absolute precision
+  size_t        m_keyframe;  // number of frames between keyframes
+
+  // offset of each frame
+  std::vector<uint64_t> m_index;
+
+  // last decoded frame (quantized), to read frames in sequence without restarting at a keyframe
+  Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> m_prev;
+  size_t m_iprev;
+
+public:
+
+  // constructor: open the file, read (or reconstruct) the index
+  TrajectoryReader() = default;
+  TrajectoryReader(const std::string &fname);
+
+  // return the number of frames, the precision, and the number of frames between keyframes
+  size_t size()      const;
+  double precision() const;
+  size_t keyframe()  const;
+
+  // read frame "i"
+  MatD read(size_t i);
+
+private:
+
+  // decode frame "i", given that the previous frame is stored (not needed for keyframes)
+  void decode(size_t i);
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -23,6 +23,18 @@ inline Vector::Vector(const MatS &dofs) : m_dofs(dofs)
   m_N    = static_cast<size_t>(m_dofs.rows());
   m_ndim = static_cast<size_t>(m_dofs.cols());
   m_ndof = static_cast<size_t>(m_dofs.maxCoeff() + 1);
+
+  // list the particle-vector entries of each DOF (counting sort)
+  m_offset = ColS::Zero(m_ndof+1);
+  m_entry.resize(m_dofs.size());
+
+  for ( auto k = 0 ; k < m_dofs.size() ; ++k ) m_offset(m_dofs.data()[k]+1) += 1;
+
+  for ( size_t d = 0 ; d < m_ndof ; ++d ) m_offset(d+1) += m_offset(d);
+
+  ColS next = m_offset.head(m_ndof);
+
+  for ( auto k = 0 ; k < m_dofs.size() ; ++k ) m_entry(next(m_dofs.data()[k])++) = k;
 }
 
 // ----------------------------------- particle scalar -> dofval -----------------------------------
@@ -91,6 +103,22 @@ inline ColD Vector::assembleDofs(const MatD &pvector) const
   assert( static_cast<size_t>(pvector.rows()) == m_N    );
   assert( static_cast<size_t>(pvector.cols()) == m_ndim );
 
+  // deterministic: sum the entries of each DOF in a fixed order, in parallel over ranges of DOFs
+  if ( deterministic() )
+  {
+    ColD dofval(m_ndof);
+
+    size_t grain   = 16384;
+    size_t nthread = m_ndof >= 2 * grain ? default_nthread() : 1;
+
+    parallel_range(m_ndof, grain, nthread, [&](size_t begin, size_t end)
+    {
+      assembleDofs(pvector, dofval, begin, end);
+    });
+
+    return dofval;
+  }
+
   // list of DOF values
   ColD dofval = ColD::Zero(m_ndof);
 
@@ -122,6 +150,97 @@ inline ColD Vector::assembleDofs(const MatD &pvector) const
 
 // -------------------------------------------------------------------------------------------------
 
+inline void Vector::assembleDofs(const MatD &pvector, ColD &dofval, size_t begin, size_t end) const
+{
+  // check input
+  assert( static_cast<size_t>(pvector.rows()) == m_N    );
+  assert( static_cast<size_t>(pvector.cols()) == m_ndim );
+  assert( static_cast<size_t>(dofval.size())  == m_ndof );
+  assert( begin <= end && end <= m_ndof );
+
+  const double *data = pvector.data();
+
+  // sum the entries of each DOF, in increasing order
+  for ( size_t d = begin ; d < end ; ++d )
+  {
+    double value = 0.0;
+
+    for ( size_t k = m_offset(d) ; k < m_offset(d+1) ; ++k ) value += data[m_entry(k)];
+
+    dofval(d) = value;
+  }
+}
+
+// --------------------------------- pair tangent -> sparse matrix ----------------------------------
+
+inline SpMatD Vector::assembleSparse(const MatS &particles, const MatD &tangent) const
+{
+  // check input
+  assert( particles.rows() == tangent.rows() );
+  assert( static_cast<size_t>(tangent.cols()) == m_ndim * m_ndim );
+
+  // list of non-zero entries
+  std::vector<Eigen::Triplet<double>> entries;
+  entries.reserve(4 * particles.rows() * m_ndim * m_ndim);
+
+  // loop over all pairs
+  for ( auto p = 0 ; p < particles.rows() ; ++p )
+  {
+    // - extract particle numbers
+    auto i = particles(p,0);
+    auto j = particles(p,1);
+    // - add blocks: [[+K, -K], [-K, +K]]
+    for ( size_t a = 0 ; a < m_ndim ; ++a )
+    {
+      for ( size_t b = 0 ; b < m_ndim ; ++b )
+      {
+        double K = tangent(p,a*m_ndim+b);
+
+        entries.emplace_back(m_dofs(i,a), m_dofs(i,b),  K);
+        entries.emplace_back(m_dofs(j,a), m_dofs(j,b),  K);
+        entries.emplace_back(m_dofs(i,a), m_dofs(j,b), -K);
+        entries.emplace_back(m_dofs(j,a), m_dofs(i,b), -K);
+      }
+    }
+  }
+
+  // assemble (adds entries that occur more than once)
+  SpMatD out(m_ndof, m_ndof);
+  out.setFromTriplets(entries.begin(), entries.end());
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline SpMatD Vector::assembleSparse(const MatD &tangent) const
+{
+  // check input
+  assert( static_cast<size_t>(tangent.rows()) == m_N );
+  assert( static_cast<size_t>(tangent.cols()) == m_ndim * m_ndim );
+
+  // list of non-zero entries
+  std::vector<Eigen::Triplet<double>> entries;
+
+  // loop over all particles, skip those without interaction
+  for ( size_t i = 0 ; i < m_N ; ++i )
+  {
+    if ( tangent.row(i).isZero(0.0) ) continue;
+
+    for ( size_t a = 0 ; a < m_ndim ; ++a )
+      for ( size_t b = 0 ; b < m_ndim ; ++b )
+        entries.emplace_back(m_dofs(i,a), m_dofs(i,b), tangent(i,a*m_ndim+b));
+  }
+
+  // assemble (adds entries that occur more than once)
+  SpMatD out(m_ndof, m_ndof);
+  out.setFromTriplets(entries.begin(), entries.end());
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
 } // namespace ...
 
 // =================================================================================================
@@ -24,6 +24,13 @@ private:
   // particles
   MatS m_dofs;   // DOF-number [N, ndim]
 
+  // inverse of "m_dofs": the (flat) particle-vector entries of DOF "d" are
+  // "m_entry(m_offset(d)), ..., m_entry(m_offset(d+1)-1)", in increasing order (used by the
+  // deterministic "assembleDofs"; built by the constructor in O(N*ndim), and stored in addition to
+  // "m_dofs": "(ndof + 1 + N*ndim) * sizeof(Index)" bytes)
+  ColS m_offset; // [ndof+1]
+  ColS m_entry;  // [N*ndim]
+
   // dimensions
   size_t m_N;    // number of particles
   size_t m_ndim; // number of spatial dimensions
@@ -42,9 +49,29 @@ public:
   // reconstruct particle vectors: [ndof] -> [N, ndim]
   MatD asParticle(const ColD &dofval) const;
 
-  // assemble vectors (adds entries that occur more that once): [N, ndim] -> [ndof]
+  // assemble vectors (adds entries that occur more that once): [N, ndim] -> [ndof]; in
+  // deterministic mode (see "deterministic()") the entries of each DOF are added in a fixed order,
+  // in parallel over the DOFs, the result equals that of a serial assembly. This gathers through
+  // "m_offset" and "m_entry" (an indirect read of each entry, instead of an indirect write), and
+  // is threaded only from "2 * 16384" DOFs on (in ranges of 16384 DOFs), such that it costs about
+  // as much as a serial scatter per thread. In fast mode (with OpenMP) each thread scatters to its
+  // own buffer [ndof], the buffers are added in the order in which the threads finish.
   ColD assembleDofs(const MatD &pvector) const;
 
+  // assemble the DOFs "begin, ..., end-1" of a particle vector [N, ndim] into "dofval" [ndof],
+  // serially and in the order of the deterministic mode (without threads or global settings: it can
+  // be called from a task of the thread pool, and ranges can be assembled concurrently)
+  void assembleDofs(const MatD &pvector, ColD &dofval, size_t begin, size_t end) const;
+
+  // assemble the tangent of pair interactions [ndof, ndof], from the tangent of the force on the
+  // first particle w.r.t. the difference "j - i": [n, ndim*ndim] (row-major blocks), such that the
+  // result is the derivative of minus the force w.r.t. the DOFs
+  SpMatD assembleSparse(const MatS &particles, const MatD &tangent) const;
+
+  // assemble the tangent of single-particle interactions (e.g. walls) [ndof, ndof], from the
+  // tangent of minus the force on each particle w.r.t. its position: [N, ndim*ndim]
+  SpMatD assembleSparse(const MatD &tangent) const;
+
 };
 
 // -------------------------------------------------------------------------------------------------
@@ -0,0 +1,445 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_WALL_CPP
+#define GOOSEDEM_WALL_CPP
+
+// -------------------------------------------------------------------------------------------------
+
+#include "Wall.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+inline Wall::Wall() : Wall(WallShape::plane, ColD(), ColD(), 0.0, ContactLaw::linear, 0.0)
+{
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline Wall::Wall(WallShape shape, ColD x0, ColD n, double R, ContactLaw law, double k,
+  double eta, double r) :
+  m_shape(shape), m_x0(std::move(x0)), m_n(std::move(n)), m_R(R), m_law(law), m_k(k), m_eta(eta),
+  m_r(r)
+{
+  // check input: a plane needs a normal, a cylinder an axis in 3-d
+  assert( m_n.size() == m_x0.size() || ( m_shape != WallShape::plane && m_x0.size() == 2 ) );
+  assert( m_shape == WallShape::plane || m_R > 0.0 );
+
+  // normalize the normal or axis (not used for a cylinder in 2-d)
+  if ( m_x0.size() == 2 && m_shape != WallShape::plane ) m_n = ColD();
+  if ( m_n.size() > 0 ) m_n /= m_n.norm();
+
+  // fixed
+  set_motion(ColD::Zero(m_x0.size()));
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Wall::set_motion(const ColD &v, const ColD &A, double omega)
+{
+  assert( v.size() == m_x0.size() );
+  assert( A.size() == m_x0.size() || A.size() == 0 );
+
+  m_v     = v;
+  m_A     = A.size() > 0 ? A : ColD::Zero(m_x0.size());
+  m_omega = omega;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Wall::position(double t) const
+{
+  return m_x0 + m_v * t + m_A * std::sin(m_omega * t);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Wall::velocity(double t) const
+{
+  return m_v + m_A * m_omega * std::cos(m_omega * t);
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline double Wall::distance(const double *x, const ColD &x0, double *N, double &curvature) const
+{
+  // dimensions
+  auto ndim = x0.size();
+
+  // position w.r.t. the reference point
+  for ( auto d = 0 ; d < ndim ; ++d ) N[d] = x[d] - x0(d);
+
+  // plane: distance along the normal
+  if ( m_shape == WallShape::plane )
+  {
+    double dist = 0.0;
+
+    for ( auto d = 0 ; d < ndim ; ++d ) { dist += N[d] * m_n(d); N[d] = m_n(d); }
+
+    curvature = 0.0;
+
+    return dist;
+  }
+
+  // cylinder: remove the component along the axis (3-d), the radial distance "rho"
+  if ( m_n.size() > 0 )
+  {
+    double da = 0.0;
+
+    for ( auto d = 0 ; d < ndim ; ++d ) da += N[d] * m_n(d);
+    for ( auto d = 0 ; d < ndim ; ++d ) N[d] -= da * m_n(d);
+  }
+
+  double rho = 0.0;
+
+  for ( auto d = 0 ; d < ndim ; ++d ) rho += N[d] * N[d];
+
+  rho = std::sqrt(rho);
+
+  // - on the axis: no normal
+  if ( rho == 0.0 )
+  {
+    for ( auto d = 0 ; d < ndim ; ++d ) N[d] = 0.0;
+
+    curvature = 0.0;
+
+    return m_shape == WallShape::cylinder_inside ? m_R : -m_R;
+  }
+
+  // - normal pointing to the particle: inwards (particles inside) or outwards (particles outside)
+  double sign = m_shape == WallShape::cylinder_inside ? -1.0 : 1.0;
+
+  for ( auto d = 0 ; d < ndim ; ++d ) N[d] *= sign / rho;
+
+  curvature = sign / rho;
+
+  return sign * ( rho - m_R );
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline void Wall::contact(double delta, double &f, double &df) const
+{
+  switch ( m_law )
+  {
+    case ContactLaw::linear: f = m_k * delta; df = m_k; break;
+    case ContactLaw::hertz : f = m_k * delta * std::sqrt(delta); df = 1.5 * m_k * std::sqrt(delta);
+                             break;
+    default: throw std::runtime_error("GooseDEM::Wall: unknown contact law");
+  }
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline double Wall::normal_velocity(const double *v, const ColD &vw, const double *N) const
+{
+  double vn = 0.0;
+
+  for ( auto d = 0 ; d < vw.size() ; ++d ) vn += ( v[d] - vw(d) ) * N[d];
+
+  return vn;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Wall::force(const MatD &X, const MatD &V, double t) const
+{
+  // check input
+  assert( X.cols() == m_x0.size() );
+  assert( V.rows() == X.rows() && V.cols() == X.cols() );
+
+  // dimensions
+  auto n    = X.rows(); // number of particles
+  auto ndim = X.cols(); // number of dimensions
+
+  // zero-initialize force per particle
+  MatD F = MatD::Zero(n, ndim);
+
+  // position and velocity of the wall
+  ColD x0 = position(t);
+  ColD vw = velocity(t);
+
+  // local variables
+  cppmat::cartesian::vector<double> N(ndim); // normal of the wall
+  double dist;  // distance to the wall
+  double curv;  // curvature of the wall
+  double f;     // magnitude of the contact force
+  double df;    // derivative of the magnitude of the contact force
+  double vn;    // normal velocity w.r.t. the wall
+  double fn;    // magnitude of the total normal force
+
+  // loop over all particles
+  for ( auto i = 0 ; i < n ; ++i )
+  {
+    // - distance to the wall, skip particles that are not in contact
+    dist = distance(X.data()+i*ndim, x0, N.data(), curv);
+    if ( dist >= m_r ) continue;
+    // - magnitude of the contact force
+    contact(m_r - dist, f, df);
+    // - normal velocity w.r.t. the wall
+    vn = normal_velocity(V.data()+i*ndim, vw, N.data());
+    // - force: the contact only pushes
+    fn = std::max(0.0, f - m_eta * vn);
+    for ( auto d = 0 ; d < ndim ; ++d ) F(i,d) = fn * N(d);
+  }
+
+  return F;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Wall::potential(const MatD &X, double t) const
+{
+  // check input
+  assert( X.cols() == m_x0.size() );
+
+  // dimensions
+  auto n    = X.rows(); // number of particles
+  auto ndim = X.cols(); // number of dimensions
+
+  // zero-initialize energy per particle
+  ColD E = ColD::Zero(n);
+
+  // position of the wall
+  ColD x0 = position(t);
+
+  // local variables
+  cppmat::cartesian::vector<double> N(ndim); // normal of the wall
+  double dist;  // distance to the wall
+  double curv;  // curvature of the wall
+  double delta; // penetration
+
+  // loop over all particles
+  for ( auto i = 0 ; i < n ; ++i )
+  {
+    // - distance to the wall, skip particles that are not in contact
+    dist = distance(X.data()+i*ndim, x0, N.data(), curv);
+    if ( dist >= m_r ) continue;
+    // - energy
+    delta = m_r - dist;
+    switch ( m_law )
+    {
+      case ContactLaw::linear: E(i) = .5 * m_k * delta * delta; break;
+      case ContactLaw::hertz : E(i) = .4 * m_k * delta * delta * std::sqrt(delta); break;
+      default: throw std::runtime_error("GooseDEM::Wall: unknown contact law");
+    }
+  }
+
+  return E;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColD Wall::stiffness(const MatD &X, double t) const
+{
+  // check input
+  assert( X.cols() == m_x0.size() );
+
+  // dimensions
+  auto n    = X.rows(); // number of particles
+  auto ndim = X.cols(); // number of dimensions
+
+  // zero-initialize stiffness per particle
+  ColD K = ColD::Zero(n);
+
+  // position of the wall
+  ColD x0 = position(t);
+
+  // local variables
+  cppmat::cartesian::vector<double> N(ndim); // normal of the wall
+  double dist;  // distance to the wall
+  double curv;  // curvature of the wall
+  double f;     // magnitude of the contact force
+  double df;    // derivative of the magnitude of the contact force
+
+  // loop over all particles
+  for ( auto i = 0 ; i < n ; ++i )
+  {
+    // - distance to the wall, skip particles that are not in contact
+    dist = distance(X.data()+i*ndim, x0, N.data(), curv);
+    if ( dist >= m_r ) continue;
+    // - largest of the normal stiffness and the geometric stiffness
+    contact(m_r - dist, f, df);
+    K(i) = std::max(std::abs(df), std::abs(f * curv));
+  }
+
+  return K;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Wall::tangent(const MatD &X, const MatD &V, double t) const
+{
+  // check input
+  assert( X.cols() == m_x0.size() );
+  assert( V.rows() == X.rows() && V.cols() == X.cols() );
+
+  // dimensions
+  auto n    = X.rows(); // number of particles
+  auto ndim = X.cols(); // number of dimensions
+
+  // zero-initialize tangent per particle
+  MatD K = MatD::Zero(n, ndim*ndim);
+
+  // position and velocity of the wall
+  ColD x0 = position(t);
+  ColD vw = velocity(t);
+
+  // local variables
+  cppmat::cartesian::vector<double> N(ndim); // normal of the wall
+  double dist;  // distance to the wall
+  double curv;  // curvature of the wall
+  double f;     // magnitude of the contact force
+  double df;    // derivative of the magnitude of the contact force
+  double P;     // projection on the tangent plane of the wall (excluding the axis)
+
+  // loop over all particles
+  for ( auto i = 0 ; i < n ; ++i )
+  {
+    // - distance to the wall, skip particles that are not in contact
+    dist = distance(X.data()+i*ndim, x0, N.data(), curv);
+    if ( dist >= m_r ) continue;
+    // - magnitude of the contact force
+    contact(m_r - dist, f, df);
+    // - skip released particles
+    if ( f - m_eta * normal_velocity(V.data()+i*ndim, vw, N.data()) <= 0.0 ) continue;
+    // - tangent: "df * N N - f * curvature * (I - N N - a a)"
+    for ( auto a = 0 ; a < ndim ; ++a )
+    {
+      for ( auto b = 0 ; b < ndim ; ++b )
+      {
+        P = ( a == b ? 1.0 : 0.0 ) - N(a) * N(b);
+        if ( m_n.size() > 0 && m_shape != WallShape::plane ) P -= m_n(a) * m_n(b);
+        K(i,a*ndim+b) = df * N(a) * N(b) - f * curv * P;
+      }
+    }
+  }
+
+  return K;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline MatD Wall::damping(const MatD &X, const MatD &V, double t) const
+{
+  // check input
+  assert( X.cols() == m_x0.size() );
+  assert( V.rows() == X.rows() && V.cols() == X.cols() );
+
+  // dimensions
+  auto n    = X.rows(); // number of particles
+  auto ndim = X.cols(); // number of dimensions
+
+  // zero-initialize tangent per particle
+  MatD C = MatD::Zero(n, ndim*ndim);
+
+  // position and velocity of the wall
+  ColD x0 = position(t);
+  ColD vw = velocity(t);
+
+  // local variables
+  cppmat::cartesian::vector<double> N(ndim); // normal of the wall
+  double dist;  // distance to the wall
+  double curv;  // curvature of the wall
+  double f;     // magnitude of the contact force
+  double df;    // derivative of the magnitude of the contact force
+
+  // loop over all particles in contact: "eta * N N"
+  for ( auto i = 0 ; i < n ; ++i )
+  {
+    // - distance to the wall, skip particles that are not in contact
+    dist = distance(X.data()+i*ndim, x0, N.data(), curv);
+    if ( dist >= m_r ) continue;
+    // - magnitude of the contact force
+    contact(m_r - dist, f, df);
+    // - skip released particles
+    if ( f - m_eta * normal_velocity(V.data()+i*ndim, vw, N.data()) <= 0.0 ) continue;
+    // - tangent
+    for ( auto a = 0 ; a < ndim ; ++a )
+      for ( auto b = 0 ; b < ndim ; ++b )
+        C(i,a*ndim+b) = m_eta * N(a) * N(b);
+  }
+
+  return C;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ColS Wall::contacts(const MatD &X, double t) const
+{
+  // check input
+  assert( X.cols() == m_x0.size() );
+
+  // dimensions
+  auto n    = X.rows(); // number of particles
+  auto ndim = X.cols(); // number of dimensions
+
+  // position of the wall
+  ColD x0 = position(t);
+
+  // local variables
+  cppmat::cartesian::vector<double> N(ndim); // normal of the wall
+  double curv; // curvature of the wall
+
+  // list the particles in contact
+  ColS   out(n);
+  size_t k = 0;
+
+  for ( auto i = 0 ; i < n ; ++i )
+    if ( distance(X.data()+i*ndim, x0, N.data(), curv) < m_r )
+      out(k++) = i;
+
+  out.conservativeResize(k);
+
+  return out;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline WallShape Wall::shape() const
+{
+  return m_shape;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline ContactLaw Wall::law() const
+{
+  return m_law;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline double Wall::k() const
+{
+  return m_k;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline double Wall::eta() const
+{
+  return m_eta;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+inline double Wall::r() const
+{
+  return m_r;
+}
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
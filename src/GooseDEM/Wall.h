@@ -0,0 +1,128 @@
+/* =================================================================================================
+
+(c - MIT) T.W.J. de Geus (Tom) | tom@geus.me | www.geus.me | github.com/tdegeus/GooseDEM
+
+================================================================================================= */
+
+#ifndef GOOSEDEM_WALL_H
+#define GOOSEDEM_WALL_H
+
+// -------------------------------------------------------------------------------------------------
+
+#include "GooseDEM.h"
+
+// -------------------------------------------------------------------------------------------------
+
+namespace GooseDEM {
+
+// -------------------------------------------------------------------------------------------------
+
+// shape of a wall
+enum class WallShape
+{
+  plane,            // plane through "x0" with normal "n": the particles are on the side of "n"
+  cylinder_inside,  // cylinder with axis "n" through "x0" and radius "R": the particles are inside
+  cylinder_outside  // cylinder with axis "n" through "x0" and radius "R": the particles are outside
+};
+
+// magnitude of the contact force as a function of the penetration "delta"
+enum class ContactLaw
+{
+  linear, // "k * delta"
+  hertz   // "k * delta^(3/2)"
+};
+
+// -------------------------------------------------------------------------------------------------
+
+// Analytic wall, that interacts with all particles through a per-particle distance check (instead
+// of a layer of fixed particles connected to the bulk by pairs). A particle is in contact if its
+// distance to the wall is less than the contact distance "r" (e.g. the particle radius); the wall
+// then pushes it along the wall normal, with a force that follows from the contact law and a
+// viscous damping "eta" of the normal velocity relative to the wall. The contact only pushes: if
+// the damping exceeds the elastic force (a fast receding particle) the particle is released. The
+// wall can move: "x0(t) = x0 + v t + A sin(omega t)". In 2-d a cylinder is a circle (the axis is
+// not used). The wall does not apply the periodicity of the box.
+
+class Wall
+{
+private:
+
+  // geometry
+  WallShape m_shape;
+  ColD      m_x0;    // reference point at "t = 0"            [ndim]
+  ColD      m_n;     // unit normal (plane) or axis (cylinder) [ndim]
+  double    m_R;     // radius (cylinder)
+
+  // contact
+  ContactLaw m_law;
+  double     m_k;    // stiffness
+  double     m_eta;  // damping constant
+  double     m_r;    // contact distance
+
+  // motion
+  ColD   m_v;        // velocity  [ndim]
+  ColD   m_A;        // amplitude [ndim]
+  double m_omega;    // angular frequency
+
+public:
+
+  // constructor
+  Wall();
+  Wall(WallShape shape, ColD x0, ColD n, double R, ContactLaw law, double k, double eta=0.0,
+    double r=0.0);
+
+  // set the motion "x0(t) = x0 + v t + A sin(omega t)" (default: fixed)
+  void set_motion(const ColD &v, const ColD &A=ColD(), double omega=0.0);
+
+  // return the position of the reference point, and the velocity of the wall, at time "t" [ndim]
+  ColD position(double t) const;
+  ColD velocity(double t) const;
+
+  // compute the force on each particle [N, ndim] (zero for the particles that are not in contact)
+  MatD force(const MatD &x, const MatD &v, double t) const;
+
+  // compute the potential energy of the contact of each particle [N]
+  ColD potential(const MatD &x, double t) const;
+
+  // compute the stiffness of the contact of each particle [N]: the largest eigenvalue (in absolute
+  // value) of the tangent
+  ColD stiffness(const MatD &x, double t) const;
+
+  // compute the derivative of minus the elastic force on each particle w.r.t. its position, and of
+  // minus the viscous force w.r.t. its velocity [N, ndim*ndim] (row-major blocks) (zero for the
+  // particles that are released, see above)
+  MatD tangent(const MatD &x, const MatD &v, double t) const;
+  MatD damping(const MatD &x, const MatD &v, double t) const;
+
+  // return the particles in contact
+  ColS contacts(const MatD &x, double t) const;
+
+  // return parameters
+  WallShape  shape() const;
+  ContactLaw law()   const;
+  double     k()     const;
+  double     eta()   const;
+  double     r()     const;
+
+private:
+
+  // compute the distance of a particle to the wall at "x0" (positive on the side of the particles),
+  // the unit normal "N" at the closest point of the wall (pointing to the particle), and the
+  // curvature of the wall (such that "dN/dx = curvature * (I - N N - a a)")
+  double distance(const double *x, const ColD &x0, double *N, double &curvature) const;
+
+  // compute the magnitude of the contact force and its derivative w.r.t. the penetration
+  void contact(double delta, double &f, double &df) const;
+
+  // compute the velocity "v" of a particle relative to the wall velocity "vw", along the normal "N"
+  double normal_velocity(const double *v, const ColD &vw, const double *N) const;
+
+};
+
+// -------------------------------------------------------------------------------------------------
+
+}
+
+// -------------------------------------------------------------------------------------------------
+
+#endif
@@ -9,6 +9,7 @@
 
 #include <pybind11/pybind11.h>
 #include <pybind11/eigen.h>
+#include <pybind11/stl.h>
 
 #include <cppmat/pybind11.h>
 
@@ -26,11 +27,33 @@ typedef GooseDEM::ColD ColD;
 typedef GooseDEM::ColS ColS;
 typedef GooseDEM::MatD MatD;
 typedef GooseDEM::MatS MatS;
+typedef GooseDEM::ColT ColT;
 // - const arrays
 typedef const GooseDEM::ColD cColD;
 typedef const GooseDEM::ColS cColS;
 typedef const GooseDEM::MatD cMatD;
 typedef const GooseDEM::MatS cMatS;
+// - non-owning views of (row-major) integer arrays, e.g. "np.load(..., mmap_mode='r')"
+typedef Eigen::Matrix<int32_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatI32;
+typedef Eigen::Matrix<int64_t, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> MatI64;
+typedef Eigen::Ref<const MatI32> rMatI32;
+typedef Eigen::Ref<const MatI64> rMatI64;
+
+// =================================================================================================
+
+// construct the topology directly from the integer data (only a strided view is first copied)
+template <class T>
+std::shared_ptr<const M::Topology> topology(const Eigen::Ref<const T> &particles, size_t N=0)
+{
+  if ( particles.cols() != 2 ) throw std::runtime_error("GooseDEM: particle pairs must be [n, 2]");
+
+  if ( particles.outerStride() == 2 )
+    return std::make_shared<const M::Topology>(particles.data(), particles.rows(), N);
+
+  T copy = particles;
+
+  return std::make_shared<const M::Topology>(copy.data(), copy.rows(), N);
+}
 
 // ======================= Trampoline for parent class - GooseDEM/Geometry.h =======================
 
@@ -53,6 +76,16 @@ public:
   void set_x(const MatD &pvector) override { PYBIND11_OVERLOAD_PURE( void, M::Geometry, set_x, pvector); }
   void set_v(const ColD &dofval)  override { PYBIND11_OVERLOAD_PURE( void, M::Geometry, set_v, dofval); }
   void set_a(const ColD &dofval)  override { PYBIND11_OVERLOAD_PURE( void, M::Geometry, set_a, dofval); }
+  ColD solve_level(size_t level)  override { PYBIND11_OVERLOAD     ( ColD, M::Geometry, solve_level, level); }
+  double dt_crit() const          override { PYBIND11_OVERLOAD     ( double, M::Geometry, dt_crit); }
+  double energy() const           override { PYBIND11_OVERLOAD     ( double, M::Geometry, energy); }
+  double potential() const        override { PYBIND11_OVERLOAD     ( double, M::Geometry, potential); }
+  ColD dofs_m() const             override { PYBIND11_OVERLOAD     ( ColD, M::Geometry, dofs_m); }
+  ColS coordination() const       override { PYBIND11_OVERLOAD     ( ColS, M::Geometry, coordination); }
+  ColS iip() const                override { PYBIND11_OVERLOAD     ( ColS, M::Geometry, iip); }
+  M::SpMatD dofs_K() const        override { PYBIND11_OVERLOAD     ( M::SpMatD, M::Geometry, dofs_K); }
+  M::SpMatD dofs_C() const        override { PYBIND11_OVERLOAD     ( M::SpMatD, M::Geometry, dofs_C); }
+  MatD asParticle(const ColD &dofval) const override { PYBIND11_OVERLOAD( MatD, M::Geometry, asParticle, dofval); }
 };
 
 // =========================================== GooseDEM ============================================
@@ -61,20 +94,151 @@ PYBIND11_MODULE(GooseDEM, m) {
 
 m.doc() = "Simple DEM simulation";
 
+// ================================ GooseDEM - GooseDEM/Periodic.h =================================
+
+py::class_<M::Periodic>(m, "Periodic")
+  // constructor
+  .def(py::init<>())
+  .def(py::init<cColD &>(), "Periodic: orthogonal box", py::arg("L"))
+  .def(py::init<cMatD &>(), "Periodic: triclinic box" , py::arg("H"))
+  // methods
+  .def("set_shearRate", &M::Periodic::set_shearRate, py::arg("gammadot"), py::arg("i")=0, py::arg("j")=1)
+  .def("set_shear"    , &M::Periodic::set_shear    , py::arg("gamma"   ), py::arg("i")=0, py::arg("j")=1)
+  .def("timestep"     , &M::Periodic::timestep     , py::arg("dt"))
+  .def("H"            , &M::Periodic::H            )
+  .def("Hdot"         , &M::Periodic::Hdot         )
+  .def("periodic"     , &M::Periodic::periodic     )
+  // print to screen
+  .def("__repr__",
+    [](const M::Periodic &a){ return "<GooseDEM.Periodic>"; }
+  );
+
+// ================================ GooseDEM - GooseDEM/Topology.h =================================
+
+py::class_<M::Topology, std::shared_ptr<M::Topology>>(m, "Topology")
+  // constructor
+  .def(
+    py::init<cMatS &, size_t>(),
+    "Topology: graph of particle pairs",
+    py::arg("particles"),
+    py::arg("N")=0
+  )
+  .def(
+    py::init([](rMatI32 particles, size_t N) {
+      return std::const_pointer_cast<M::Topology>(topology<MatI32>(particles, N));
+    }),
+    "Topology: graph of particle pairs (int32, without copy)",
+    py::arg("particles"),
+    py::arg("N")=0
+  )
+  .def(
+    py::init([](rMatI64 particles, size_t N) {
+      return std::const_pointer_cast<M::Topology>(topology<MatI64>(particles, N));
+    }),
+    "Topology: graph of particle pairs (int64, without copy)",
+    py::arg("particles"),
+    py::arg("N")=0
+  )
+  // methods
+  .def("N"           , &M::Topology::N)
+  .def("size"        , &M::Topology::size)
+  .def("ncolor"      , &M::Topology::ncolor)
+  .def("particles"   , &M::Topology::particles)
+  .def("degree"      , py::overload_cast<      >(&M::Topology::degree, py::const_))
+  .def("degree"      , py::overload_cast<size_t>(&M::Topology::degree, py::const_), py::arg("i"))
+  .def("neighbors"   , &M::Topology::neighbors, py::arg("i"))
+  .def("pairs"       , &M::Topology::pairs    , py::arg("i"))
+  .def("offset"      , &M::Topology::offset)
+  .def("neighbor"    , &M::Topology::neighbor)
+  .def("pair"        , &M::Topology::pair)
+  .def("color"       , &M::Topology::color)
+  .def("colored"     , py::overload_cast<      >(&M::Topology::colored, py::const_))
+  .def("colored"     , py::overload_cast<size_t>(&M::Topology::colored, py::const_), py::arg("c"))
+  .def("color_offset", &M::Topology::color_offset)
+  // print to screen
+  .def("__repr__",
+    [](const M::Topology &a){ return "<GooseDEM.Topology>"; }
+  );
+
 // ================================= GooseDEM - GooseDEM/Spring.h ==================================
 
 py::class_<M::Spring>(m, "Spring")
   // constructor
   .def(
-    py::init<cMatS &, cColD &, cColD &>(),
+    py::init<MatS, ColD, ColD>(),
     "Spring",
     py::arg("particles"),
     py::arg("k"),
     py::arg("D0")
   )
+  .def(
+    py::init([](rMatI32 particles, ColD k, ColD D0) {
+      return M::Spring(topology<MatI32>(particles), std::move(k), std::move(D0));
+    }),
+    "Spring (int32 particles, without copy)",
+    py::arg("particles"),
+    py::arg("k"),
+    py::arg("D0")
+  )
+  .def(
+    py::init([](rMatI64 particles, ColD k, ColD D0) {
+      return M::Spring(topology<MatI64>(particles), std::move(k), std::move(D0));
+    }),
+    "Spring (int64 particles, without copy)",
+    py::arg("particles"),
+    py::arg("k"),
+    py::arg("D0")
+  )
+  .def(
+    py::init([](std::shared_ptr<M::Topology> topology, ColD k, ColD D0) {
+      return M::Spring(topology, std::move(k), std::move(D0));
+    }),
+    "Spring (shared topology)",
+    py::arg("topology"),
+    py::arg("k"),
+    py::arg("D0")
+  )
+  .def(
+    py::init<MatS, ColT, ColD, ColD>(),
+    "Spring (parameters per type)",
+    py::arg("particles"),
+    py::arg("type"),
+    py::arg("k"),
+    py::arg("D0")
+  )
+  .def(
+    py::init([](std::shared_ptr<M::Topology> topology, ColT type, ColD k, ColD D0) {
+      return M::Spring(topology, std::move(type), std::move(k), std::move(D0));
+    }),
+    "Spring (shared topology, parameters per type)",
+    py::arg("topology"),
+    py::arg("type"),
+    py::arg("k"),
+    py::arg("D0")
+  )
   // methods
-  .def("force"       , &M::Spring::force       )
+  .def("force"       , py::overload_cast<cMatD &                  >(&M::Spring::force, py::const_))
+  .def("force"       , py::overload_cast<cMatD &, const M::Periodic &>(&M::Spring::force, py::const_))
   .def("coordination", &M::Spring::coordination)
+  .def("potential"   , py::overload_cast<cMatD &                  >(&M::Spring::potential, py::const_))
+  .def("potential"   , py::overload_cast<cMatD &, const M::Periodic &>(&M::Spring::potential, py::const_))
+  .def("stiffness"   , &M::Spring::stiffness)
+  .def("tangent"     , &M::Spring::tangent)
+  .def("particles"   , &M::Spring::particles)
+  .def("k"           , &M::Spring::k)
+  .def("D0"          , &M::Spring::D0)
+  .def("type"        , &M::Spring::type)
+  .def("ntype"       , &M::Spring::ntype)
+  .def("eps_c"       , &M::Spring::eps_c)
+  .def("set_rupture" , &M::Spring::set_rupture, py::arg("eps_c"))
+  .def("rupture"     , &M::Spring::rupture, py::arg("x"), py::arg("box")=M::Periodic())
+  .def("deactivate"  , &M::Spring::deactivate, py::arg("index"))
+  .def("active"      , &M::Spring::active)
+  .def("ndead"       , &M::Spring::ndead)
+  .def("compact"     , py::overload_cast<>(&M::Spring::compact))
+  .def("append"      , py::overload_cast<cMatS &, cColD &, cColD &, cColD &>(&M::Spring::append), py::arg("particles"), py::arg("k"), py::arg("D0"), py::arg("eps_c")=ColD())
+  .def("append"      , py::overload_cast<cMatS &, const ColT &, cColD &>(&M::Spring::append), py::arg("particles"), py::arg("type"), py::arg("eps_c")=ColD())
+  .def("topology"    , [](const M::Spring &a){ return std::const_pointer_cast<M::Topology>(a.topology()); })
   // print to screen
   .def("__repr__",
     [](const M::Spring &a){ return "<GooseDEM.Spring>"; }
@@ -85,19 +249,121 @@ py::class_<M::Spring>(m, "Spring")
 py::class_<M::Dashpot>(m, "Dashpot")
   // constructor
   .def(
-    py::init<cMatS &, cColD &>(),
+    py::init<MatS, ColD>(),
     "Dashpot",
     py::arg("particles"),
     py::arg("eta")
   )
+  .def(
+    py::init([](rMatI32 particles, ColD eta) {
+      return M::Dashpot(topology<MatI32>(particles), std::move(eta));
+    }),
+    "Dashpot (int32 particles, without copy)",
+    py::arg("particles"),
+    py::arg("eta")
+  )
+  .def(
+    py::init([](rMatI64 particles, ColD eta) {
+      return M::Dashpot(topology<MatI64>(particles), std::move(eta));
+    }),
+    "Dashpot (int64 particles, without copy)",
+    py::arg("particles"),
+    py::arg("eta")
+  )
+  .def(
+    py::init([](std::shared_ptr<M::Topology> topology, ColD eta) {
+      return M::Dashpot(topology, std::move(eta));
+    }),
+    "Dashpot (shared topology)",
+    py::arg("topology"),
+    py::arg("eta")
+  )
+  .def(
+    py::init<MatS, ColT, ColD>(),
+    "Dashpot (parameters per type)",
+    py::arg("particles"),
+    py::arg("type"),
+    py::arg("eta")
+  )
+  .def(
+    py::init([](std::shared_ptr<M::Topology> topology, ColT type, ColD eta) {
+      return M::Dashpot(topology, std::move(type), std::move(eta));
+    }),
+    "Dashpot (shared topology, parameters per type)",
+    py::arg("topology"),
+    py::arg("type"),
+    py::arg("eta")
+  )
   // methods
-  .def("force"       , &M::Dashpot::force       )
+  .def("force"       , py::overload_cast<cMatD &                          >(&M::Dashpot::force, py::const_))
+  .def("force"       , py::overload_cast<cMatD &, cMatD &, const M::Periodic &>(&M::Dashpot::force, py::const_))
   .def("coordination", &M::Dashpot::coordination)
+  .def("tangent"     , &M::Dashpot::tangent)
+  .def("particles"   , &M::Dashpot::particles)
+  .def("eta"         , &M::Dashpot::eta)
+  .def("type"        , &M::Dashpot::type)
+  .def("ntype"       , &M::Dashpot::ntype)
+  .def("deactivate"  , &M::Dashpot::deactivate, py::arg("index"))
+  .def("active"      , &M::Dashpot::active)
+  .def("ndead"       , &M::Dashpot::ndead)
+  .def("compact"     , py::overload_cast<>(&M::Dashpot::compact))
+  .def("append"      , py::overload_cast<cMatS &, cColD &>(&M::Dashpot::append), py::arg("particles"), py::arg("eta"))
+  .def("append"      , py::overload_cast<cMatS &, const ColT &>(&M::Dashpot::append), py::arg("particles"), py::arg("type"))
+  .def("topology"    , [](const M::Dashpot &a){ return std::const_pointer_cast<M::Topology>(a.topology()); })
   // print to screen
   .def("__repr__",
     [](const M::Dashpot &a){ return "<GooseDEM.Dashpot>"; }
   );
 
+// =================================== GooseDEM - GooseDEM/Wall.h ===================================
+
+py::enum_<M::WallShape>(m, "WallShape")
+  .value("plane"           , M::WallShape::plane           )
+  .value("cylinder_inside" , M::WallShape::cylinder_inside )
+  .value("cylinder_outside", M::WallShape::cylinder_outside);
+
+// -------------------------------------------------------------------------------------------------
+
+py::enum_<M::ContactLaw>(m, "ContactLaw")
+  .value("linear", M::ContactLaw::linear)
+  .value("hertz" , M::ContactLaw::hertz );
+
+// -------------------------------------------------------------------------------------------------
+
+py::class_<M::Wall>(m, "Wall")
+  // constructor
+  .def(
+    py::init<M::WallShape, ColD, ColD, double, M::ContactLaw, double, double, double>(),
+    "Wall",
+    py::arg("shape"),
+    py::arg("x0"),
+    py::arg("n"),
+    py::arg("R"),
+    py::arg("law"),
+    py::arg("k"),
+    py::arg("eta")=0.0,
+    py::arg("r")=0.0
+  )
+  // methods
+  .def("set_motion", &M::Wall::set_motion, py::arg("v"), py::arg("A")=ColD(), py::arg("omega")=0.0)
+  .def("position"  , &M::Wall::position  , py::arg("t"))
+  .def("velocity"  , &M::Wall::velocity  , py::arg("t"))
+  .def("force"     , &M::Wall::force     , py::arg("x"), py::arg("v"), py::arg("t"))
+  .def("potential" , &M::Wall::potential , py::arg("x"), py::arg("t"))
+  .def("stiffness" , &M::Wall::stiffness , py::arg("x"), py::arg("t"))
+  .def("tangent"   , &M::Wall::tangent   , py::arg("x"), py::arg("v"), py::arg("t"))
+  .def("damping"   , &M::Wall::damping   , py::arg("x"), py::arg("v"), py::arg("t"))
+  .def("contacts"  , &M::Wall::contacts  , py::arg("x"), py::arg("t"))
+  .def("shape"     , &M::Wall::shape)
+  .def("law"       , &M::Wall::law  )
+  .def("k"         , &M::Wall::k    )
+  .def("eta"       , &M::Wall::eta  )
+  .def("r"         , &M::Wall::r    )
+  // print to screen
+  .def("__repr__",
+    [](const M::Wall &a){ return "<GooseDEM.Wall>"; }
+  );
+
 // ================================ GooseDEM - GooseDEM/Geometry.h =================================
 
 py::class_<M::Geometry, PyGeometry>(m, "Geometry")
@@ -105,14 +371,23 @@ py::class_<M::Geometry, PyGeometry>(m, "Geometry")
   .def(py::init<>())
   // methods
   .def("solve"   , &M::Geometry::solve)
+  .def("solve_level", &M::Geometry::solve_level, py::arg("level"))
   .def("reset"   , &M::Geometry::reset)
   .def("stop"    , &M::Geometry::stop)
   .def("timestep", &M::Geometry::timestep)
+  .def("dt_crit" , &M::Geometry::dt_crit)
+  .def("energy"  , &M::Geometry::energy)
+  .def("potential", &M::Geometry::potential)
   .def("x"       , &M::Geometry::x)
   .def("v"       , &M::Geometry::v)
   .def("a"       , &M::Geometry::a)
   .def("dofs_v"  , &M::Geometry::dofs_v)
   .def("dofs_a"  , &M::Geometry::dofs_a)
+  .def("dofs_m"  , &M::Geometry::dofs_m)
+  .def("iip"     , &M::Geometry::iip)
+  .def("dofs_K"  , &M::Geometry::dofs_K)
+  .def("dofs_C"  , &M::Geometry::dofs_C)
+  .def("asParticle", &M::Geometry::asParticle)
   .def("set_x"   , &M::Geometry::set_x)
   .def("set_v"   , &M::Geometry::set_v)
   .def("set_v"   , &M::Geometry::set_v)
@@ -121,6 +396,21 @@ py::class_<M::Geometry, PyGeometry>(m, "Geometry")
     [](const M::Geometry &a){ return "<GooseDEM.Geometry>"; }
   );
 
+// -------------------------------------------------------------------------------------------------
+
+m.def("distance", py::overload_cast<cMatD &>(&M::distance),
+  "find distance between all particles",
+  py::arg("x")
+);
+
+// -------------------------------------------------------------------------------------------------
+
+m.def("distance", py::overload_cast<cMatD &, const M::Periodic &>(&M::distance),
+  "find distance between all particles (to the nearest periodic image)",
+  py::arg("x"),
+  py::arg("box")
+);
+
 // ================================== GooseDEM - GooseDEM/Write.h ==================================
 
 m.def("dump", py::overload_cast<const std::string &, cColD &>(&M::dump),
@@ -137,23 +427,293 @@ m.def("dump", py::overload_cast<const std::string &, cMatD &>(&M::dump),
   py::arg("matrix")
 );
 
+// ================================ GooseDEM - GooseDEM/Trajectory.h ===============================
+
+py::class_<M::TrajectoryWriter>(m, "TrajectoryWriter")
+  // constructor
+  .def(
+    py::init<const std::string &, double, size_t>(),
+    "TrajectoryWriter: compressed trajectory",
+    py::arg("fname"),
+    py::arg("precision"),
+    py::arg("keyframe")=16
+  )
+  // methods
+  .def("write", py::overload_cast<cColD &>(&M::TrajectoryWriter::write), py::arg("matrix"))
+  .def("write", py::overload_cast<cMatD &>(&M::TrajectoryWriter::write), py::arg("matrix"))
+  .def("size" , &M::TrajectoryWriter::size )
+  .def("close", &M::TrajectoryWriter::close)
+  // print to screen
+  .def("__repr__",
+    [](const M::TrajectoryWriter &a){ return "<GooseDEM.TrajectoryWriter>"; }
+  );
+
+// -------------------------------------------------------------------------------------------------
+
+py::class_<M::TrajectoryReader>(m, "TrajectoryReader")
+  // constructor
+  .def(
+    py::init<const std::string &>(),
+    "TrajectoryReader: compressed trajectory",
+    py::arg("fname")
+  )
+  // methods
+  .def("read"     , &M::TrajectoryReader::read     , py::arg("i"))
+  .def("size"     , &M::TrajectoryReader::size     )
+  .def("precision", &M::TrajectoryReader::precision)
+  .def("keyframe" , &M::TrajectoryReader::keyframe )
+  // print to screen
+  .def("__repr__",
+    [](const M::TrajectoryReader &a){ return "<GooseDEM.TrajectoryReader>"; }
+  );
+
+// =============================== GooseDEM - GooseDEM/AsyncWriter.h ===============================
+
+py::class_<M::AsyncWriter>(m, "AsyncWriter")
+  // constructor
+  .def(
+    py::init<size_t>(),
+    "AsyncWriter: write snapshots from a background thread",
+    py::arg("capacity")=2
+  )
+  // methods
+  .def("dump" , py::overload_cast<const std::string &, cColD &>(&M::AsyncWriter::dump), py::arg("fname"), py::arg("matrix"), py::call_guard<py::gil_scoped_release>())
+  .def("dump" , py::overload_cast<const std::string &, cMatD &>(&M::AsyncWriter::dump), py::arg("fname"), py::arg("matrix"), py::call_guard<py::gil_scoped_release>())
+  .def("write", py::overload_cast<M::TrajectoryWriter &, cColD &>(&M::AsyncWriter::write), py::arg("trajectory"), py::arg("matrix"), py::keep_alive<1,2>(), py::call_guard<py::gil_scoped_release>())
+  .def("write", py::overload_cast<M::TrajectoryWriter &, cMatD &>(&M::AsyncWriter::write), py::arg("trajectory"), py::arg("matrix"), py::keep_alive<1,2>(), py::call_guard<py::gil_scoped_release>())
+  .def("flush", &M::AsyncWriter::flush, py::call_guard<py::gil_scoped_release>())
+  .def("size" , &M::AsyncWriter::size )
+  // print to screen
+  .def("__repr__",
+    [](const M::AsyncWriter &a){ return "<GooseDEM.AsyncWriter>"; }
+  );
+
+// ================================= GooseDEM - GooseDEM/Parallel.h ================================
+
+m.def("deterministic", &M::deterministic,
+  "return true if reductions are bitwise reproducible (independent of the number of threads)"
+);
+
+m.def("set_deterministic", &M::set_deterministic,
+  "switch between bitwise reproducible (deterministic) and fast reductions",
+  py::arg("deterministic")
+);
+
+// ================================= GooseDEM - GooseDEM/Iterate.h =================================
+
+py::enum_<M::Criterion>(m, "Criterion")
+  .value("residual_L1" , M::Criterion::residual_L1 )
+  .value("residual_L2" , M::Criterion::residual_L2 )
+  .value("residual_max", M::Criterion::residual_max)
+  .value("kinetic"     , M::Criterion::kinetic     )
+  .value("displacement", M::Criterion::displacement);
+
+// -------------------------------------------------------------------------------------------------
+
+py::class_<M::Convergence>(m, "Convergence")
+  // constructor
+  .def(py::init<size_t, size_t, double, size_t>(), "Convergence: amortized convergence check", py::arg("stride")=1, py::arg("max_stride")=1, py::arg("growth")=2., py::arg("nhistory")=1)
+  // methods
+  .def("add"     , &M::Convergence::add, py::arg("criterion"), py::arg("tol"))
+  .def("reset"   , &M::Convergence::reset   )
+  .def("criteria", &M::Convergence::criteria)
+  .def("values"  , &M::Convergence::values  )
+  .def("ncheck"  , &M::Convergence::ncheck  )
+  // print to screen
+  .def("__repr__",
+    [](const M::Convergence &a){ return "<GooseDEM.Convergence>"; }
+  );
+
+// ================================= GooseDEM - GooseDEM/Observer.h ================================
+
+py::enum_<M::Observable>(m, "Observable")
+  .value("kinetic"     , M::Observable::kinetic     )
+  .value("vmax"        , M::Observable::vmax        )
+  .value("residual"    , M::Observable::residual    )
+  .value("coordination", M::Observable::coordination)
+  .value("potential"   , M::Observable::potential   );
+
+// -------------------------------------------------------------------------------------------------
+
+py::class_<M::Observer>(m, "Observer")
+  // constructor
+  .def(py::init<size_t>(), "Observer: time series of observables", py::arg("stride")=1)
+  .def(py::init<const std::vector<M::Observable> &, size_t>(), "Observer: time series of observables", py::arg("observables"), py::arg("stride")=1)
+  // methods
+  .def("add"        , &M::Observer::add, py::arg("observable"))
+  .def("observables", &M::Observer::observables)
+  .def("size"       , &M::Observer::size )
+  .def("step"       , &M::Observer::step )
+  .def("time"       , &M::Observer::time )
+  .def("data"       , py::overload_cast<            >(&M::Observer::data, py::const_))
+  .def("data"       , py::overload_cast<M::Observable>(&M::Observer::data, py::const_), py::arg("observable"))
+  .def("clear"      , &M::Observer::clear)
+  // print to screen
+  .def("__repr__",
+    [](const M::Observer &a){ return "<GooseDEM.Observer>"; }
+  );
+
 // ============================= GooseDEM - GooseDEM/TimeIntegration.h =============================
 
-m.def("velocityVerlet", &M::velocityVerlet,
+m.def("Verlet", static_cast<void(*)(M::Geometry &, double, M::Observer *)>(&M::Verlet),
   "evaluate one time step",
   py::arg("geometry"),
-  py::arg("dt")
+  py::arg("dt"),
+  py::arg("observer")=nullptr
 );
 
 // -------------------------------------------------------------------------------------------------
 
-m.def("quasiStaticVelocityVerlet", &M::quasiStaticVelocityVerlet,
+m.def("velocityVerlet", static_cast<void(*)(M::Geometry &, double, M::Observer *)>(&M::velocityVerlet),
+  "evaluate one time step",
+  py::arg("geometry"),
+  py::arg("dt"),
+  py::arg("observer")=nullptr
+);
+
+// -------------------------------------------------------------------------------------------------
+
+m.def("adaptiveVelocityVerlet",
+  [](M::Geometry &g, double dt, double dx_max, double dE_max, double growth, double safety,
+    M::Observer *observer) {
+    double used = M::adaptiveVelocityVerlet(g, dt, dx_max, dE_max, growth, safety, observer);
+    return std::make_tuple(used, dt);
+  },
+  "evaluate one time step with an adaptive time step, returns (used time step, proposed next time step)",
+  py::arg("geometry"),
+  py::arg("dt"),
+  py::arg("dx_max"),
+  py::arg("dE_max")=std::numeric_limits<double>::infinity(),
+  py::arg("growth")=1.1,
+  py::arg("safety")=0.9,
+  py::arg("observer")=nullptr
+);
+
+// -------------------------------------------------------------------------------------------------
+
+m.def("quasiStaticAdaptiveVelocityVerlet",
+  [](M::Geometry &g, double dt, double dx_max, double tol, double growth, double safety,
+    M::Observer *observer) {
+    size_t iiter = M::quasiStaticAdaptiveVelocityVerlet(g, dt, dx_max, tol, growth, safety,
+      observer);
+    return std::make_tuple(iiter, dt);
+  },
+  "iterate until all particles have come to a rest (adaptive time step), returns (number of iterations, proposed next time step)",
+  py::arg("geometry"),
+  py::arg("dt"),
+  py::arg("dx_max"),
+  py::arg("tol"),
+  py::arg("growth")=1.1,
+  py::arg("safety")=0.9,
+  py::arg("observer")=nullptr
+);
+
+// -------------------------------------------------------------------------------------------------
+
+m.def("RESPA", &M::RESPA,
+  "evaluate one time step using the r-RESPA multiple-time-stepping scheme",
+  py::arg("geometry"),
+  py::arg("dt"),
+  py::arg("nsub"),
+  py::arg("observer")=nullptr
+);
+
+// -------------------------------------------------------------------------------------------------
+
+py::class_<M::Newmark>(m, "Newmark")
+
+  .def(py::init<double,double>(), "Newmark: implicit time integration", py::arg("beta")=0.25, py::arg("gamma")=0.5)
+
+  .def("step", &M::Newmark::step,
+    "evaluate one time step, returns the number of iterations",
+    py::arg("geometry"),
+    py::arg("dt"),
+    py::arg("tol")=1.e-8,
+    py::arg("max_iter")=50,
+    py::arg("observer")=nullptr
+  )
+  // print to screen
+  .def("__repr__",
+    [](const M::Newmark &a){ return "<GooseDEM.Newmark>"; }
+  );
+
+// -------------------------------------------------------------------------------------------------
+
+m.def("quasiStaticVelocityVerlet", static_cast<size_t(*)(M::Geometry &, double, double, M::Observer *)>(&M::quasiStaticVelocityVerlet),
   "iterate until all particles have come to a rest",
   py::arg("geometry"),
   py::arg("dt"),
-  py::arg("tol")
+  py::arg("tol"),
+  py::arg("observer")=nullptr
+);
+
+m.def("quasiStaticVelocityVerlet", static_cast<size_t(*)(M::Geometry &, double, M::Convergence &, M::Observer *)>(&M::quasiStaticVelocityVerlet),
+  "iterate until all particles have come to a rest, as checked by a convergence object",
+  py::arg("geometry"),
+  py::arg("dt"),
+  py::arg("convergence"),
+  py::arg("observer")=nullptr
 );
 
+// -------------------------------------------------------------------------------------------------
+
+m.def("quasiStaticNewton", &M::quasiStaticNewton,
+  "iterate until static equilibrium using the Newton-Raphson method (with dynamic relaxation as fall-back)",
+  py::arg("geometry"),
+  py::arg("dt"),
+  py::arg("tol"),
+  py::arg("max_iter")=50
+);
+
+// ================================= GooseDEM - GooseDEM/Minimize.h ================================
+
+m.def("quasiStaticLBFGS", &M::quasiStaticLBFGS,
+  "minimize the potential energy using limited memory BFGS",
+  py::arg("geometry"),
+  py::arg("tol"),
+  py::arg("dx_max"),
+  py::arg("m")=10
+);
+
+// -------------------------------------------------------------------------------------------------
+
+m.def("quasiStaticCG", &M::quasiStaticCG,
+  "minimize the potential energy using Polak-Ribiere nonlinear conjugate gradient",
+  py::arg("geometry"),
+  py::arg("tol"),
+  py::arg("dx_max")
+);
+
+// ================================== GooseDEM - GooseDEM/Load.h ===================================
+
+py::class_<M::Npy>(m, "Npy")
+  // constructor
+  .def(
+    py::init<const std::string &>(),
+    "Npy: memory mapped '.npy' file",
+    py::arg("fname")
+  )
+  .def(
+    py::init<const std::string &, const std::string &, const std::vector<size_t> &, size_t>(),
+    "Npy: memory mapped raw binary file",
+    py::arg("fname"),
+    py::arg("descr"),
+    py::arg("shape"),
+    py::arg("offset")=0
+  )
+  // methods
+  .def("descr"     , &M::Npy::descr )
+  .def("shape"     , &M::Npy::shape )
+  .def("size"      , &M::Npy::size  )
+  .def("asColD"    , &M::Npy::asColD)
+  .def("asMatD"    , &M::Npy::asMatD)
+  .def("asMatS"    , &M::Npy::asMatS)
+  .def("asTopology", [](const M::Npy &a, size_t N){ return std::const_pointer_cast<M::Topology>(a.asTopology(N)); }, py::arg("N")=0)
+  // print to screen
+  .def("__repr__",
+    [](const M::Npy &a){ return "<GooseDEM.Npy>"; }
+  );
+
 // =================================================================================================
 
 }